@@ -0,0 +1,44 @@
+#ifndef ADDITIVE_HE_H
+#define ADDITIVE_HE_H
+
+#include "ECElGamal.h"
+#include "PaillierCrypto.h"
+#include <cstddef>
+
+// 加法同态后端：EncryptedValue、SEP_*、SCP 只通过下列成员使用具体方案
+//   PublicKey / PrivateKey / Ciphertext      密钥与密文类型
+//   linear_combination(pk, cts, scalars, n)  E(sum s_k m_k)
+//   same_key(a, b)                           两把公钥是否相同
+//   is_zero(sk, c)                           明文是否为 0
+//   PrivateKey::encrypt(m)                   持有私钥一方加密
+//   PrivateKey::decrypt_small(c)             有符号小明文解密
+
+struct PaillierScheme {
+    typedef PaillierPublicKey PublicKey;
+    typedef PaillierPrivateKey PrivateKey;
+    typedef mpz_class Ciphertext;
+
+    static Ciphertext linear_combination(const PublicKey& pk, const Ciphertext* const* ciphertexts,
+                                         const mpz_class* scalars, size_t count) {
+        return PaillierHomomorphic::linear_combination(pk, ciphertexts, scalars, count);
+    }
+    static bool same_key(const PublicKey& a, const PublicKey& b) { return a.get_n() == b.get_n(); }
+    static bool is_zero(const PrivateKey& sk, const Ciphertext& c) { return sk.decrypt(c) == 0; }
+};
+
+struct ECElGamalScheme {
+    typedef ECElGamalPublicKey PublicKey;
+    typedef ECElGamalPrivateKey PrivateKey;
+    typedef ECElGamalCiphertext Ciphertext;
+
+    static Ciphertext linear_combination(const PublicKey& pk, const Ciphertext* const* ciphertexts,
+                                         const mpz_class* scalars, size_t count) {
+        return pk.linear_combination(ciphertexts, scalars, count);
+    }
+    static bool same_key(const PublicKey& a, const PublicKey& b) {
+        return a.get_group()->get_curve_nid() == b.get_group()->get_curve_nid() && a.get_h() == b.get_h();
+    }
+    static bool is_zero(const PrivateKey& sk, const Ciphertext& c) { return sk.is_zero(c); }
+};
+
+#endif // ADDITIVE_HE_H
@@ -0,0 +1,333 @@
+#include "ECElGamal.h"
+#include "SecureRandom.h"
+#include <openssl/bn.h>
+#include <cstring>
+#include <stdexcept>
+
+namespace {
+
+// 每个线程复用一个 BN_CTX
+BN_CTX* bn_ctx() {
+    thread_local std::unique_ptr<BN_CTX, decltype(&BN_CTX_free)> ctx(BN_CTX_new(), BN_CTX_free);
+    if (!ctx) {
+        throw std::runtime_error("Failed to allocate BN_CTX");
+    }
+    return ctx.get();
+}
+
+// mpz 到 BIGNUM 的转换，先约化到 [0, order)
+class BigNum {
+public:
+    BigNum(const mpz_class& value, const mpz_class& order) : bn(BN_new()) {
+        if (bn == nullptr) {
+            throw std::runtime_error("Failed to allocate BIGNUM");
+        }
+        mpz_class reduced;
+        mpz_mod(reduced.get_mpz_t(), value.get_mpz_t(), order.get_mpz_t());
+        size_t len = (mpz_sizeinbase(reduced.get_mpz_t(), 2) + 7) / 8;
+        std::vector<unsigned char> bytes(len);
+        size_t written = 0;
+        mpz_export(bytes.data(), &written, 1, 1, 1, 0, reduced.get_mpz_t());
+        BN_bin2bn(bytes.data(), static_cast<int>(written), bn);
+        OPENSSL_cleanse(bytes.data(), bytes.size());
+    }
+    ~BigNum() { BN_clear_free(bn); }
+
+    BigNum(const BigNum&) = delete;
+    BigNum& operator=(const BigNum&) = delete;
+
+    const BIGNUM* get() const { return bn; }
+
+private:
+    BIGNUM* bn;
+};
+
+void check(int ok, const char* what) {
+    if (ok != 1) {
+        throw std::runtime_error(what);
+    }
+}
+
+// out = scalar * in；小标量（SEP 中的 ±1、±2）用倍点加点，其余交给 EC_POINT_mul
+void scale_point(ECPoint& out, const ECPoint& in, const mpz_class& scalar, const mpz_class& order) {
+    const EC_GROUP* group = out.get_group()->get();
+    mpz_class magnitude = abs(scalar);
+    if (mpz_sizeinbase(magnitude.get_mpz_t(), 2) <= 16) {
+        unsigned long s = magnitude.get_ui();
+        check(EC_POINT_set_to_infinity(group, out.get()), "EC_POINT_set_to_infinity failed");
+        for (int bit = 15; bit >= 0; bit--) {
+            check(EC_POINT_dbl(group, out.get(), out.get(), bn_ctx()), "EC_POINT_dbl failed");
+            if ((s >> bit) & 1) {
+                check(EC_POINT_add(group, out.get(), out.get(), in.get(), bn_ctx()), "EC_POINT_add failed");
+            }
+        }
+        if (scalar < 0) {
+            check(EC_POINT_invert(group, out.get(), bn_ctx()), "EC_POINT_invert failed");
+        }
+        return;
+    }
+    BigNum s(scalar, order);
+    check(EC_POINT_mul(group, out.get(), nullptr, in.get(), s.get(), bn_ctx()), "EC_POINT_mul failed");
+}
+
+}
+
+// ECGroup implementation
+ECGroup::ECGroup(int curve_nid) : group(EC_GROUP_new_by_curve_name(curve_nid)), curve_nid(curve_nid) {
+    if (group == nullptr) {
+        throw std::runtime_error("Unsupported elliptic curve");
+    }
+    const BIGNUM* bn_order = EC_GROUP_get0_order(group);
+    std::vector<unsigned char> bytes(BN_num_bytes(bn_order));
+    BN_bn2bin(bn_order, bytes.data());
+    mpz_import(order.get_mpz_t(), bytes.size(), 1, 1, 1, 0, bytes.data());
+    field_bytes = (EC_GROUP_get_degree(group) + 7) / 8;
+}
+
+ECGroup::~ECGroup() {
+    EC_GROUP_free(group);
+}
+
+// ECPoint implementation
+ECPoint::ECPoint(std::shared_ptr<const ECGroup> group)
+    : group(std::move(group)), point(EC_POINT_new(this->group->get())) {
+    if (point == nullptr) {
+        throw std::runtime_error("Failed to allocate EC_POINT");
+    }
+    EC_POINT_set_to_infinity(this->group->get(), point);
+}
+
+ECPoint::ECPoint(const ECPoint& other) : group(other.group), point(nullptr) {
+    if (other.point != nullptr) {
+        point = EC_POINT_dup(other.point, group->get());
+        if (point == nullptr) {
+            throw std::runtime_error("Failed to copy EC_POINT");
+        }
+    }
+}
+
+ECPoint::ECPoint(ECPoint&& other) noexcept : group(std::move(other.group)), point(other.point) {
+    other.point = nullptr;
+}
+
+ECPoint& ECPoint::operator=(const ECPoint& other) {
+    if (this != &other) {
+        ECPoint copy(other);
+        *this = std::move(copy);
+    }
+    return *this;
+}
+
+ECPoint& ECPoint::operator=(ECPoint&& other) noexcept {
+    if (this != &other) {
+        EC_POINT_free(point);
+        group = std::move(other.group);
+        point = other.point;
+        other.point = nullptr;
+    }
+    return *this;
+}
+
+ECPoint::~ECPoint() {
+    EC_POINT_free(point);
+}
+
+bool ECPoint::is_infinity() const {
+    return EC_POINT_is_at_infinity(group->get(), point) == 1;
+}
+
+bool ECPoint::operator==(const ECPoint& other) const {
+    return EC_POINT_cmp(group->get(), point, other.point, bn_ctx()) == 0;
+}
+
+void ECPoint::to_bytes(unsigned char* out) const {
+    size_t len = group->point_bytes();
+    if (is_infinity()) {
+        std::memset(out, 0, len);
+        return;
+    }
+    if (EC_POINT_point2oct(group->get(), point, POINT_CONVERSION_COMPRESSED, out, len, bn_ctx()) != len) {
+        throw std::runtime_error("Failed to encode EC point");
+    }
+}
+
+ECPoint ECPoint::from_bytes(std::shared_ptr<const ECGroup> group, const unsigned char* in) {
+    size_t len = group->point_bytes();
+    ECPoint result(group);
+    bool all_zero = true;
+    for (size_t i = 0; i < len; i++) {
+        all_zero = all_zero && in[i] == 0;
+    }
+    if (!all_zero) {
+        check(EC_POINT_oct2point(group->get(), result.point, in, len, bn_ctx()), "Invalid EC point encoding");
+    }
+    return result;
+}
+
+// ECElGamalCiphertext implementation
+std::vector<unsigned char> ECElGamalCiphertext::serialize() const {
+    size_t len = c1.get_group()->point_bytes();
+    std::vector<unsigned char> out(2 * len);
+    c1.to_bytes(out.data());
+    c2.to_bytes(out.data() + len);
+    return out;
+}
+
+ECElGamalCiphertext ECElGamalCiphertext::deserialize(std::shared_ptr<const ECGroup> group, const unsigned char* in) {
+    size_t len = group->point_bytes();
+    return ECElGamalCiphertext{ECPoint::from_bytes(group, in), ECPoint::from_bytes(group, in + len)};
+}
+
+// ECElGamalPublicKey implementation
+ECElGamalPublicKey::ECElGamalPublicKey(std::shared_ptr<const ECGroup> group, const ECPoint& h)
+    : group(std::move(group)), h(h) {}
+
+ECElGamalCiphertext ECElGamalPublicKey::encrypt(const mpz_class& message) const {
+    const EC_GROUP* g = group->get();
+    const mpz_class& order = group->get_order();
+    BigNum r(SecureRandom::random_below(order - 1) + 1, order);
+    BigNum m(message, order);
+
+    ECElGamalCiphertext result{ECPoint(group), ECPoint(group)};
+    check(EC_POINT_mul(g, result.c1.get(), r.get(), nullptr, nullptr, bn_ctx()), "EC_POINT_mul failed");
+    // m*G + r*H 一次完成，G 走 OpenSSL 的预计算表
+    check(EC_POINT_mul(g, result.c2.get(), m.get(), h.get(), r.get(), bn_ctx()), "EC_POINT_mul failed");
+    return result;
+}
+
+ECElGamalCiphertext ECElGamalPublicKey::linear_combination(const ECElGamalCiphertext* const* ciphertexts,
+                                                           const mpz_class* scalars, size_t count) const {
+    const EC_GROUP* g = group->get();
+    ECElGamalCiphertext result{ECPoint(group), ECPoint(group)};
+    ECPoint term(group);
+    for (size_t k = 0; k < count; k++) {
+        const ECElGamalCiphertext& c = *ciphertexts[k];
+        if (scalars[k] == 0) {
+            continue;
+        }
+        if (scalars[k] == 1) {
+            check(EC_POINT_add(g, result.c1.get(), result.c1.get(), c.c1.get(), bn_ctx()), "EC_POINT_add failed");
+            check(EC_POINT_add(g, result.c2.get(), result.c2.get(), c.c2.get(), bn_ctx()), "EC_POINT_add failed");
+            continue;
+        }
+        scale_point(term, c.c1, scalars[k], group->get_order());
+        check(EC_POINT_add(g, result.c1.get(), result.c1.get(), term.get(), bn_ctx()), "EC_POINT_add failed");
+        scale_point(term, c.c2, scalars[k], group->get_order());
+        check(EC_POINT_add(g, result.c2.get(), result.c2.get(), term.get(), bn_ctx()), "EC_POINT_add failed");
+    }
+    return result;
+}
+
+// ECBabyStepTable implementation
+ECBabyStepTable::ECBabyStepTable(std::shared_ptr<const ECGroup> group, int baby_step_bits)
+    : group(group), baby_step_bits(baby_step_bits), giant_step(group) {
+    if (baby_step_bits < 1 || baby_step_bits > 24) {
+        throw std::runtime_error("Baby-step table size must be between 2^1 and 2^24");
+    }
+    const EC_GROUP* g = group->get();
+    size_t len = group->point_bytes();
+    size_t entries = size_t(1) << baby_step_bits;
+    encodings.resize(entries * len);
+    index.reserve(entries);
+
+    // 第 0 项为无穷远点，不入索引
+    ECPoint point(group);
+    const EC_POINT* generator = EC_GROUP_get0_generator(g);
+    for (size_t j = 1; j < entries; j++) {
+        check(EC_POINT_add(g, point.get(), point.get(), generator, bn_ctx()), "EC_POINT_add failed");
+        unsigned char* encoding = &encodings[j * len];
+        point.to_bytes(encoding);
+        uint64_t key;
+        std::memcpy(&key, encoding + 1, sizeof(key));
+        index.emplace(key, static_cast<uint32_t>(j));
+    }
+    check(EC_POINT_add(g, giant_step.get(), point.get(), generator, bn_ctx()), "EC_POINT_add failed");
+}
+
+bool ECBabyStepTable::lookup(const ECPoint& point, long& value) const {
+    if (point.is_infinity()) {
+        value = 0;
+        return true;
+    }
+    size_t len = group->point_bytes();
+    unsigned char encoding[256];
+    point.to_bytes(encoding);
+    uint64_t key;
+    std::memcpy(&key, encoding + 1, sizeof(key));
+    auto it = index.find(key);
+    if (it == index.end()) {
+        return false;
+    }
+    const unsigned char* entry = &encodings[it->second * len];
+    if (std::memcmp(entry + 1, encoding + 1, len - 1) != 0) {
+        return false;
+    }
+    // x 坐标相同：前缀字节（y 的奇偶）相同为 +j，不同为 -j
+    value = (entry[0] == encoding[0]) ? static_cast<long>(it->second) : -static_cast<long>(it->second);
+    return true;
+}
+
+// ECElGamalPrivateKey implementation
+ECElGamalPrivateKey::ECElGamalPrivateKey(const ECElGamalPublicKey& public_key, const mpz_class& x,
+                                         std::shared_ptr<const ECBabyStepTable> table, int range_bits)
+    : public_key(public_key), x(x), table(std::move(table)), range_bits(range_bits) {}
+
+ECElGamalPrivateKey ECElGamalPrivateKey::generate(const ECElGamalConfig& config) {
+    if (config.range_bits < config.baby_step_bits || config.range_bits > 48) {
+        throw std::runtime_error("Plaintext range must be between the baby-step size and 2^48");
+    }
+    auto group = std::make_shared<const ECGroup>(config.curve_nid);
+    const mpz_class& order = group->get_order();
+    mpz_class x = SecureRandom::random_below(order - 1) + 1;
+
+    ECPoint h(group);
+    BigNum bn_x(x, order);
+    check(EC_POINT_mul(group->get(), h.get(), bn_x.get(), nullptr, nullptr, bn_ctx()), "EC_POINT_mul failed");
+
+    auto table = std::make_shared<const ECBabyStepTable>(group, config.baby_step_bits);
+    return ECElGamalPrivateKey(ECElGamalPublicKey(group, h), x, table, config.range_bits);
+}
+
+// m*G = c2 - x*c1
+ECPoint ECElGamalPrivateKey::message_point(const ECElGamalCiphertext& ciphertext) const {
+    const EC_GROUP* g = public_key.get_group()->get();
+    BigNum bn_x(x, public_key.get_group()->get_order());
+    ECPoint result(public_key.get_group());
+    check(EC_POINT_mul(g, result.get(), nullptr, ciphertext.c1.get(), bn_x.get(), bn_ctx()), "EC_POINT_mul failed");
+    check(EC_POINT_invert(g, result.get(), bn_ctx()), "EC_POINT_invert failed");
+    check(EC_POINT_add(g, result.get(), result.get(), ciphertext.c2.get(), bn_ctx()), "EC_POINT_add failed");
+    return result;
+}
+
+mpz_class ECElGamalPrivateKey::decrypt_small(const ECElGamalCiphertext& ciphertext) const {
+    const EC_GROUP* g = public_key.get_group()->get();
+    ECPoint target = message_point(ciphertext);
+    long step = 1L << table->get_baby_step_bits();
+    long giant_steps = 1L << (range_bits - table->get_baby_step_bits());
+    const ECPoint& giant = table->get_giant_step();
+
+    // 从 0 向两侧同时走大步：down = M - i*S，up = M + i*S，多数 SEP/SCP 明文在第一次查表就命中
+    long value;
+    if (table->lookup(target, value)) {
+        return mpz_class(value);
+    }
+    ECPoint down = target;
+    ECPoint up = target;
+    ECPoint neg_giant = giant;
+    check(EC_POINT_invert(g, neg_giant.get(), bn_ctx()), "EC_POINT_invert failed");
+    for (long i = 1; i <= giant_steps; i++) {
+        check(EC_POINT_add(g, down.get(), down.get(), neg_giant.get(), bn_ctx()), "EC_POINT_add failed");
+        if (table->lookup(down, value)) {
+            return mpz_class(i * step + value);
+        }
+        check(EC_POINT_add(g, up.get(), up.get(), giant.get(), bn_ctx()), "EC_POINT_add failed");
+        if (table->lookup(up, value)) {
+            return mpz_class(-i * step + value);
+        }
+    }
+    throw std::runtime_error("EC-ElGamal plaintext is outside the decryptable range");
+}
+
+bool ECElGamalPrivateKey::is_zero(const ECElGamalCiphertext& ciphertext) const {
+    return message_point(ciphertext).is_infinity();
+}
@@ -0,0 +1,150 @@
+#ifndef EC_ELGAMAL_H
+#define EC_ELGAMAL_H
+
+#include <gmpxx.h>
+#include <openssl/ec.h>
+#include <openssl/obj_mac.h>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+// 指数 EC-ElGamal：E(m) = (r*G, m*G + r*H)，H = x*G
+// 密文相加即点相加，标量乘即点乘；解密得到 m*G，只能对有界的小明文用小步大步法还原 m
+// 适用于 SEP/SCP 这类只需加法同态和小明文符号/零判断的场合
+
+// 共享的曲线参数
+class ECGroup {
+public:
+    explicit ECGroup(int curve_nid);
+    ~ECGroup();
+
+    ECGroup(const ECGroup&) = delete;
+    ECGroup& operator=(const ECGroup&) = delete;
+
+    const EC_GROUP* get() const { return group; }
+    const mpz_class& get_order() const { return order; }
+    int get_curve_nid() const { return curve_nid; }
+    // 压缩点编码长度（P-256 为 33 字节）
+    size_t point_bytes() const { return field_bytes + 1; }
+
+private:
+    EC_GROUP* group;
+    mpz_class order;
+    int curve_nid;
+    size_t field_bytes;
+};
+
+// EC_POINT 的值语义封装
+class ECPoint {
+public:
+    ECPoint() : point(nullptr) {}
+    // 无穷远点
+    explicit ECPoint(std::shared_ptr<const ECGroup> group);
+    ECPoint(const ECPoint& other);
+    ECPoint(ECPoint&& other) noexcept;
+    ECPoint& operator=(const ECPoint& other);
+    ECPoint& operator=(ECPoint&& other) noexcept;
+    ~ECPoint();
+
+    EC_POINT* get() { return point; }
+    const EC_POINT* get() const { return point; }
+    const std::shared_ptr<const ECGroup>& get_group() const { return group; }
+
+    bool is_infinity() const;
+    bool operator==(const ECPoint& other) const;
+    bool operator!=(const ECPoint& other) const { return !(*this == other); }
+
+    // 定长压缩编码，无穷远点编码为全零
+    void to_bytes(unsigned char* out) const;
+    static ECPoint from_bytes(std::shared_ptr<const ECGroup> group, const unsigned char* in);
+
+private:
+    std::shared_ptr<const ECGroup> group;
+    EC_POINT* point;
+};
+
+struct ECElGamalCiphertext {
+    ECPoint c1;  // r*G
+    ECPoint c2;  // m*G + r*H
+
+    // 两个压缩点，P-256 下共 66 字节
+    size_t serialized_size() const { return 2 * c1.get_group()->point_bytes(); }
+    std::vector<unsigned char> serialize() const;
+    static ECElGamalCiphertext deserialize(std::shared_ptr<const ECGroup> group, const unsigned char* in);
+};
+
+struct ECElGamalConfig {
+    int curve_nid = NID_X9_62_prime256v1;
+    int baby_step_bits = 12;  // 小步表 2^b 项，解密 |m| < 2^b 只需一次查表
+    int range_bits = 24;      // 可解密的明文范围 |m| < 2^range_bits，超出时解密抛出异常
+};
+
+class ECElGamalPublicKey {
+public:
+    ECElGamalPublicKey(std::shared_ptr<const ECGroup> group, const ECPoint& h);
+
+    ECElGamalCiphertext encrypt(const mpz_class& message) const;
+    // E(sum s_k m_k)：对两个分量分别做点的线性组合，count 为 0 时返回 E(0) 的无穷远点密文
+    ECElGamalCiphertext linear_combination(const ECElGamalCiphertext* const* ciphertexts, const mpz_class* scalars,
+                                           size_t count) const;
+
+    const std::shared_ptr<const ECGroup>& get_group() const { return group; }
+    const ECPoint& get_h() const { return h; }
+
+private:
+    std::shared_ptr<const ECGroup> group;
+    ECPoint h;
+};
+
+// 小步表：j*G（1 <= j < 2^b）的压缩编码，按 x 坐标前 8 字节索引；
+// -P 与 P 的 x 坐标相同，一次查表同时覆盖 ±j
+class ECBabyStepTable {
+public:
+    ECBabyStepTable(std::shared_ptr<const ECGroup> group, int baby_step_bits);
+
+    // 若 point = ±j*G（0 <= j < 2^b）返回 true 并写入 ±j
+    bool lookup(const ECPoint& point, long& value) const;
+
+    int get_baby_step_bits() const { return baby_step_bits; }
+    // 大步 2^b * G
+    const ECPoint& get_giant_step() const { return giant_step; }
+
+private:
+    std::shared_ptr<const ECGroup> group;
+    int baby_step_bits;
+    std::unordered_map<uint64_t, uint32_t> index;
+    std::vector<unsigned char> encodings;  // 第 j 项从 j * point_bytes 开始
+    ECPoint giant_step;
+};
+
+class ECElGamalPrivateKey {
+public:
+    static ECElGamalPrivateKey generate(const ECElGamalConfig& config = ECElGamalConfig());
+
+    const ECElGamalPublicKey& get_public_key() const { return public_key; }
+    ECElGamalCiphertext encrypt(const mpz_class& message) const { return public_key.encrypt(message); }
+
+    // 有符号小明文解密：|m| < 2^range_bits，否则抛出异常
+    mpz_class decrypt_small(const ECElGamalCiphertext& ciphertext) const;
+    // 指数 ElGamal 没有通用解密，与 decrypt_small 相同
+    mpz_class decrypt(const ECElGamalCiphertext& ciphertext) const { return decrypt_small(ciphertext); }
+    // 明文是否为 0：c2 == x*c1，不需要查表
+    bool is_zero(const ECElGamalCiphertext& ciphertext) const;
+
+    int get_range_bits() const { return range_bits; }
+
+private:
+    ECElGamalPrivateKey(const ECElGamalPublicKey& public_key, const mpz_class& x,
+                        std::shared_ptr<const ECBabyStepTable> table, int range_bits);
+
+    ECPoint message_point(const ECElGamalCiphertext& ciphertext) const;
+
+    ECElGamalPublicKey public_key;
+    mpz_class x;
+    std::shared_ptr<const ECBabyStepTable> table;
+    int range_bits;
+};
+
+#endif // EC_ELGAMAL_H
@@ -1,191 +1,663 @@
 #include "GarbledBloom.h"
-#include <sstream>
-#include <iomanip>
+#include "MultiBufferSha256.h"
+#include "SecureRandom.h"
+#include <immintrin.h>
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <stdexcept>
 #include <openssl/evp.h>
 
-GarbledBloomFilter::GarbledBloomFilter(int numElements, const PaillierPublicKey& pubKey) 
-    : publicKey(pubKey) {
+namespace {
+
+// 每个线程复用一个摘要上下文
+EVP_MD_CTX* digestContext() {
+    thread_local std::unique_ptr<EVP_MD_CTX, decltype(&EVP_MD_CTX_free)> ctx(EVP_MD_CTX_new(), EVP_MD_CTX_free);
+    if (!ctx) {
+        throw std::runtime_error("Failed to allocate EVP_MD_CTX");
+    }
+    return ctx.get();
+}
+
+// 显式获取一次 EVP_MD，避免每次 EVP_DigestInit_ex 都重新查找算法
+const EVP_MD* fetchDigest(const char* name) {
+    EVP_MD* md = EVP_MD_fetch(nullptr, name, nullptr);
+    if (md == nullptr) {
+        throw std::runtime_error(std::string("Digest is not available: ") + name);
+    }
+    return md;
+}
+
+// 旧方案的十种摘要，顺序与原先的 hashAlgorithms 一致
+const EVP_MD* const* legacyDigests() {
+    static const EVP_MD* const digests[GarbledBloomFilter::NUM_HASHES] = {
+        fetchDigest("MD5"), fetchDigest("SHA2-224"), fetchDigest("SHA2-256"), fetchDigest("SHA1"),
+        fetchDigest("SHA2-384"), fetchDigest("SHA2-512"), fetchDigest("SHA3-224"), fetchDigest("SHA3-256"),
+        fetchDigest("SHA3-384"), fetchDigest("SHA3-512")};
+    return digests;
+}
+
+const EVP_MD* sha256Digest() {
+    static const EVP_MD* const md = fetchDigest("SHA2-256");
+    return md;
+}
+
+// out = md(prefix || input)，返回摘要长度
+unsigned int digest(const EVP_MD* md, const unsigned char* prefix, size_t prefixLength, const std::string& input,
+                    unsigned char* out) {
+    EVP_MD_CTX* ctx = digestContext();
+    unsigned int length = 0;
+    if (EVP_DigestInit_ex(ctx, md, nullptr) != 1 ||
+        (prefixLength > 0 && EVP_DigestUpdate(ctx, prefix, prefixLength) != 1) ||
+        EVP_DigestUpdate(ctx, input.data(), input.size()) != 1 ||
+        EVP_DigestFinal_ex(ctx, out, &length) != 1) {
+        throw std::runtime_error("Digest computation failed");
+    }
+    return length;
+}
+
+static_assert(sizeof(mp_limb_t) == sizeof(uint64_t), "GBF rows assume 64-bit GMP limbs");
+
+// out ^= base 中 positions 指定的 count 行。按向量宽度分段，每段先把 k 行都异或进寄存器再写回；
+// 行按自身宽度对齐，out 可以不对齐（例如直接指向 mpz 的 limb）。Limbs 为 0 时使用运行时的 rowLimbs
+typedef void (*XorRowsFn)(uint64_t* out, const uint64_t* base, size_t rowLimbs, const size_t* positions,
+                          size_t count);
+
+template <size_t Limbs>
+__attribute__((target("avx512f"))) void xorRowsAvx512(uint64_t* out, const uint64_t* base, size_t rowLimbs,
+                                                      const size_t* positions, size_t count) {
+    const size_t limbs = Limbs != 0 ? Limbs : rowLimbs;
+    for (size_t c = 0; c < limbs; c += 8) {
+        __m512i acc = _mm512_loadu_si512(out + c);
+        for (size_t i = 0; i < count; i++) {
+            acc = _mm512_xor_si512(acc, _mm512_load_si512(base + positions[i] * limbs + c));
+        }
+        _mm512_storeu_si512(out + c, acc);
+    }
+}
+
+template <size_t Limbs>
+__attribute__((target("avx2"))) void xorRowsAvx2(uint64_t* out, const uint64_t* base, size_t rowLimbs,
+                                                 const size_t* positions, size_t count) {
+    const size_t limbs = Limbs != 0 ? Limbs : rowLimbs;
+    for (size_t c = 0; c < limbs; c += 4) {
+        __m256i acc = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(out + c));
+        for (size_t i = 0; i < count; i++) {
+            const __m256i* line = reinterpret_cast<const __m256i*>(base + positions[i] * limbs + c);
+            acc = _mm256_xor_si256(acc, _mm256_load_si256(line));
+        }
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + c), acc);
+    }
+}
+
+// x86-64 基线指令集，128 位行或不支持 AVX2 时使用
+template <size_t Limbs>
+void xorRowsSse2(uint64_t* out, const uint64_t* base, size_t rowLimbs, const size_t* positions, size_t count) {
+    const size_t limbs = Limbs != 0 ? Limbs : rowLimbs;
+    for (size_t c = 0; c < limbs; c += 2) {
+        __m128i acc = _mm_loadu_si128(reinterpret_cast<const __m128i*>(out + c));
+        for (size_t i = 0; i < count; i++) {
+            const __m128i* line = reinterpret_cast<const __m128i*>(base + positions[i] * limbs + c);
+            acc = _mm_xor_si128(acc, _mm_load_si128(line));
+        }
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + c), acc);
+    }
+}
+
+// 选择行宽能整除向量宽度的最宽实现；运行时行宽总是 8 个 limb 的倍数
+template <size_t Limbs>
+XorRowsFn selectXorRows() {
+    if constexpr (Limbs % 8 == 0) {
+        if (__builtin_cpu_supports("avx512f")) {
+            return xorRowsAvx512<Limbs>;
+        }
+    }
+    if constexpr (Limbs % 4 == 0) {
+        if (__builtin_cpu_supports("avx2")) {
+            return xorRowsAvx2<Limbs>;
+        }
+    }
+    return xorRowsSse2<Limbs>;
+}
+
+template <size_t Limbs>
+XorRowsFn xorRowsKernel() {
+    static const XorRowsFn kernel = selectXorRows<Limbs>();
+    return kernel;
+}
+
+// 把非负大整数按小端 limb 写入一行，高位补零
+void loadRow(uint64_t* out, size_t rowLimbs, const mpz_class& value) {
+    size_t size = mpz_size(value.get_mpz_t());
+    if (size > rowLimbs) {
+        throw std::runtime_error("Value does not fit in a GBF row");
+    }
+    const mp_limb_t* limbs = mpz_limbs_read(value.get_mpz_t());
+    std::copy(limbs, limbs + size, out);
+    std::fill(out + size, out + rowLimbs, 0);
+}
+
+// 种子压缩格式（本机字节序）：72 字节头部，之后 explicitCount 条记录，每条是 u64 行号加一整行
+const char COMPRESSED_MAGIC[8] = {'P', 'S', 'I', 'G', 'B', 'F', 'S', 'C'};
+const uint32_t COMPRESSED_VERSION = 2;
+const uint32_t ENDIAN_MARK = 0x01020304;
+
+struct CompressedHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t endianMark;
+    uint64_t m;
+    uint32_t rowLimbs;
+    uint16_t hashScheme;
+    uint16_t k;
+    uint64_t explicitCount;
+    unsigned char hashKey[16];
+    unsigned char seed[16];
+};
+
+static_assert(sizeof(CompressedHeader) == 72, "compressed GBF header must be 72 bytes");
+
+uint64_t loadLittleEndian64(const unsigned char* p) {
+    uint64_t value = 0;
+    for (int i = 7; i >= 0; i--) {
+        value = (value << 8) | p[i];
+    }
+    return value;
+}
+
+}
+
+mpz_class GBFView::slot(size_t i) const {
+    mpz_class value;
+    mp_limb_t* limbs = mpz_limbs_write(value.get_mpz_t(), limbsPerRow);
+    std::copy(row(i), row(i) + limbsPerRow, limbs);
+    mpz_limbs_finish(value.get_mpz_t(), limbsPerRow);
+    return value;
+}
+
+GarbledBloomBase::GarbledBloomBase(int numElements, GBFHashScheme scheme) : hashScheme(scheme) {
     // 使用与Python相同的公式计算Bloom filter大小
     m = static_cast<int>((10.0 * numElements) / 0.69);
-    lambda = 2048;
-    garbledBloomArray.resize(m);
+    k = NUM_HASHES;
+    // SHA256 模式要求 k 个位置互不相同
+    m = std::max(m, k);
+    if (hashScheme == GBFHashScheme::SHA256) {
+        SecureRandom::fill_bytes(hashKey, HASH_KEY_SIZE);
+    } else {
+        std::memset(hashKey, 0, HASH_KEY_SIZE);
+    }
 }
 
-// 使用OpenSSL的EVP接口替代弃用的函数
-std::string computeHash(const std::string& input, const std::string& algorithm) {
-    const EVP_MD* md = nullptr;
-    
-    if (algorithm == "md5") {
-        md = EVP_md5();
-    } else if (algorithm == "sha1") {
-        md = EVP_sha1();
-    } else if (algorithm == "sha224") {
-        md = EVP_sha224();
-    } else if (algorithm == "sha256") {
-        md = EVP_sha256();
-    } else if (algorithm == "sha384") {
-        md = EVP_sha384();
-    } else if (algorithm == "sha512") {
-        md = EVP_sha512();
-    } else if (algorithm == "sha3_224") {
-        md = EVP_sha3_224();
-    } else if (algorithm == "sha3_256") {
-        md = EVP_sha3_256();
-    } else if (algorithm == "sha3_384") {
-        md = EVP_sha3_384();
-    } else if (algorithm == "sha3_512") {
-        md = EVP_sha3_512();
+GarbledBloomBase::GarbledBloomBase(const GBFSizing& sizing, GBFHashScheme scheme)
+    : m(sizing.m), k(sizing.k), hashScheme(scheme) {
+    if (k < 1 || k > MAX_HASHES || m < k || (scheme == GBFHashScheme::Legacy && k != NUM_HASHES)) {
+        throw std::runtime_error("Invalid GBF sizing");
+    }
+    if (hashScheme == GBFHashScheme::SHA256) {
+        SecureRandom::fill_bytes(hashKey, HASH_KEY_SIZE);
     } else {
-        // 默认使用SHA-256
-        md = EVP_sha256();
+        std::memset(hashKey, 0, HASH_KEY_SIZE);
     }
-    
-    EVP_MD_CTX* mdctx = EVP_MD_CTX_new();
+}
+
+GBFSizing GarbledBloomBase::computeSizing(size_t numElements, size_t rowBytes, const GBFSizingPolicy& policy,
+                                          GBFHashScheme scheme) {
+    double p = policy.false_positive_rate;
+    if (!(p > 0.0 && p < 1.0) || rowBytes == 0) {
+        throw std::runtime_error("GBF false-positive rate must be in (0, 1)");
+    }
+    double n = static_cast<double>(std::max<size_t>(numElements, 1));
+
+    // 误判率 (1 - e^(-kn/m))^k 在 k = (m/n) ln 2 时最小，此时 k = log2(1/p)
+    GBFSizing sizing;
+    if (scheme == GBFHashScheme::Legacy) {
+        sizing.k = NUM_HASHES;
+    } else {
+        sizing.k = std::min(MAX_HASHES, std::max(1, static_cast<int>(std::lround(-std::log2(p)))));
+    }
+    // 固定 k 时解 (1 - e^(-kn/m))^k = p 得 m = -kn / ln(1 - p^(1/k))
+    double m = std::ceil(-sizing.k * n / std::log1p(-std::pow(p, 1.0 / sizing.k)));
+
+    if (policy.memory_budget > 0) {
+        double budgetRows = static_cast<double>(policy.memory_budget / rowBytes);
+        if (m > budgetRows) {
+            m = budgetRows;
+            if (scheme != GBFHashScheme::Legacy) {
+                sizing.k = std::min(MAX_HASHES, std::max(1, static_cast<int>(std::lround(m / n * std::log(2.0)))));
+            }
+            if (m < sizing.k) {
+                throw std::runtime_error("GBF memory budget is too small");
+            }
+        }
+    }
+    if (m > static_cast<double>(INT32_MAX)) {
+        throw std::runtime_error("GBF would exceed the maximum number of slots");
+    }
+    sizing.m = std::max(static_cast<int>(m), sizing.k);
+    sizing.expected_false_positive_rate = std::pow(-std::expm1(-sizing.k * n / sizing.m), sizing.k);
+    return sizing;
+}
+
+void GarbledBloomBase::computePositions(const std::string& element, size_t* positions) const {
     unsigned char hash[EVP_MAX_MD_SIZE];
-    unsigned int hash_len;
-    
-    EVP_DigestInit_ex(mdctx, md, NULL);
-    EVP_DigestUpdate(mdctx, input.c_str(), input.length());
-    EVP_DigestFinal_ex(mdctx, hash, &hash_len);
-    EVP_MD_CTX_free(mdctx);
-    
-    return std::string(reinterpret_cast<char*>(hash), hash_len);
+
+    if (hashScheme == GBFHashScheme::Legacy) {
+        // 与原实现逐位一致：摘要按十六进制每 8 个字符（即大端 32 位字）异或，再对 m 取模
+        const EVP_MD* const* digests = legacyDigests();
+        for (int i = 0; i < k; i++) {
+            unsigned int length = digest(digests[i], nullptr, 0, element, hash);
+            uint64_t hashValue = 0;
+            for (unsigned int j = 0; j < length; j += 4) {
+                hashValue ^= (uint64_t(hash[j]) << 24) | (uint64_t(hash[j + 1]) << 16) |
+                             (uint64_t(hash[j + 2]) << 8) | uint64_t(hash[j + 3]);
+            }
+            positions[i] = hashValue % m;
+        }
+        return;
+    }
+
+    digest(sha256Digest(), hashKey, HASH_KEY_SIZE, element, hash);
+    positionsFromDigest(hash, positions);
 }
 
-// 将哈希转换为十六进制字符串
-std::string bytesToHexString(const std::string& input) {
-    std::stringstream ss;
-    ss << std::hex << std::setfill('0');
-    for (const auto& byte : input) {
-        ss << std::setw(2) << (static_cast<int>(byte) & 0xff);
+void GarbledBloomBase::positionsFromDigest(const unsigned char* digest, size_t* positions) const {
+    // 双重哈希：pos_i = (h1 + i * h2) 映射到 [0, m)，h2 取奇数；与已选位置冲突时向后顺延
+    uint64_t h1 = loadLittleEndian64(digest);
+    uint64_t h2 = loadLittleEndian64(digest + 8) | 1;
+    for (int i = 0; i < k; i++) {
+        uint64_t h = h1 + static_cast<uint64_t>(i) * h2;
+        size_t position = static_cast<size_t>((static_cast<unsigned __int128>(h) * static_cast<uint64_t>(m)) >> 64);
+        for (int j = 0; j < i; j++) {
+            if (positions[j] == position) {
+                position = (position + 1 == static_cast<size_t>(m)) ? 0 : position + 1;
+                j = -1;
+            }
+        }
+        positions[i] = position;
     }
-    return ss.str();
 }
 
-std::vector<size_t> GarbledBloomFilter::computeHashes(const std::string& element) const {
-    std::vector<size_t> hashPositions;
-    
-    // 定义与Python相同的哈希函数
-    std::vector<std::string> hashAlgorithms = {
-        "md5", "sha224", "sha256", "sha1", "sha384", "sha512",
-        "sha3_224", "sha3_256", "sha3_384", "sha3_512"
-    };
-    
-    for (const auto& algorithm : hashAlgorithms) {
-        std::string hash = computeHash(element, algorithm);
-        std::string hexHash = bytesToHexString(hash);
-        
-        // 将十六进制字符串转换为整数并对m取模
-        size_t hashValue = 0;
-         // 直接使用哈希值的字节数组计算整数
-        /*for (size_t i = 0; i < hash.size(); ++i) {
-            hashValue = (hashValue << 8) | static_cast<unsigned char>(hash[i]);
-        } */
-        for (size_t i = 0; i < hexHash.length(); i += 8) {
-            std::string chunk = hexHash.substr(i, std::min(size_t(8), hexHash.length() - i));
-            size_t chunkValue = std::stoull(chunk, nullptr, 16);
-            hashValue ^= chunkValue;
-        }
-        
-        hashPositions.push_back(hashValue % m);
+void GarbledBloomBase::computePositionsBatch(const std::string* elements, size_t count, size_t* positions) const {
+    if (hashScheme == GBFHashScheme::Legacy) {
+        for (size_t e = 0; e < count; e++) {
+            computePositions(elements[e], positions + e * k);
+        }
+        return;
+    }
+
+    // 分块求摘要，摘要缓冲区大小固定
+    const size_t CHUNK = 256;
+    unsigned char digests[CHUNK * MultiBufferSha256::DIGEST_SIZE];
+    MultiBufferSha256 hasher;
+    for (size_t begin = 0; begin < count; begin += CHUNK) {
+        size_t chunk = std::min(CHUNK, count - begin);
+        hasher.hash(hashKey, HASH_KEY_SIZE, elements + begin, chunk, digests);
+        for (size_t e = 0; e < chunk; e++) {
+            positionsFromDigest(digests + e * MultiBufferSha256::DIGEST_SIZE, positions + (begin + e) * k);
+        }
     }
-    
-    return hashPositions;
 }
 
-mpz_class GarbledBloomFilter::generateRandomBits(int bits) const {
-    static std::mt19937_64 rng(std::random_device{}());
-    static std::uniform_int_distribution<unsigned long long> dist;
-    
-    mpz_class result;
-    int generated = 0;
-    
-    while (generated < bits) {
-        unsigned long long random_value = dist(rng);
-        
-        // 使用 GMP 函数来设置值
-        mpz_class temp;
-        mpz_import(temp.get_mpz_t(), 1, 1, sizeof(random_value), 0, 0, &random_value);
-        
-        result = (result << 64) | temp;
-        generated += 64;
+std::vector<size_t> GarbledBloomBase::computePositionsBatch(const std::vector<std::string>& elements) const {
+    std::vector<size_t> positions(elements.size() * k);
+    computePositionsBatch(elements.data(), elements.size(), positions.data());
+    return positions;
+}
+
+
+template <size_t ShareBits>
+size_t BasicGarbledBloomFilter<ShareBits>::rowLimbsFor(const PaillierPublicKey* pubKey) {
+    if (ROW_LIMBS != 0) {
+        return ROW_LIMBS;
     }
-    
-    // 确保我们只保留'bits'位
-    if (generated > bits) {
-        mpz_class mask = (mpz_class(1) << bits) - 1;
-        result &= mask;
+    if (pubKey == nullptr) {
+        return LAMBDA / 64;
     }
-    
-    return result;
+    size_t rowBits = std::max<size_t>(LAMBDA, mpz_sizeinbase(pubKey->get_n_squared().get_mpz_t(), 2));
+    return (rowBits + 511) / 512 * 8;
+}
+
+template <size_t ShareBits>
+BasicGarbledBloomFilter<ShareBits>::BasicGarbledBloomFilter(int numElements, const PaillierPublicKey& pubKey,
+                                                            GBFHashScheme scheme)
+    : GarbledBloomBase(numElements, scheme), rowLimbs(rowLimbsFor(&pubKey)),
+      publicKey(std::make_shared<const PaillierPublicKey>(pubKey)) {
+    std::memset(seed, 0, SEED_SIZE);
 }
 
+template <size_t ShareBits>
+BasicGarbledBloomFilter<ShareBits>::BasicGarbledBloomFilter(int numElements, GBFHashScheme scheme)
+    : GarbledBloomBase(numElements, scheme), rowLimbs(rowLimbsFor(nullptr)) {
+    std::memset(seed, 0, SEED_SIZE);
+}
+
+template <size_t ShareBits>
+BasicGarbledBloomFilter<ShareBits>::BasicGarbledBloomFilter(int numElements, const PaillierPublicKey& pubKey,
+                                                            const GBFSizingPolicy& policy, GBFHashScheme scheme)
+    : GarbledBloomBase(computeSizing(std::max(numElements, 0), rowLimbsFor(&pubKey) * sizeof(uint64_t), policy,
+                                     scheme),
+                       scheme),
+      rowLimbs(rowLimbsFor(&pubKey)), publicKey(std::make_shared<const PaillierPublicKey>(pubKey)) {
+    std::memset(seed, 0, SEED_SIZE);
+}
+
+template <size_t ShareBits>
+BasicGarbledBloomFilter<ShareBits>::BasicGarbledBloomFilter(int numElements, const GBFSizingPolicy& policy,
+                                                            GBFHashScheme scheme)
+    : GarbledBloomBase(computeSizing(std::max(numElements, 0), rowLimbsFor(nullptr) * sizeof(uint64_t), policy,
+                                     scheme),
+                       scheme),
+      rowLimbs(rowLimbsFor(nullptr)) {
+    std::memset(seed, 0, SEED_SIZE);
+}
 
-void GarbledBloomFilter::generate(const std::vector<std::string>& inputArray, int a) {
+template <size_t ShareBits>
+void BasicGarbledBloomFilter<ShareBits>::generate(const std::vector<std::string>& inputArray, int a,
+                                                  ThreadPool& pool) {
     //调试信息
  /*   std::cout << "Generating Garbled Bloom Filter with " << inputArray.size() << " elements..." << std::endl;*/
-    // 初始化所有位置为空
-    for (int i = 0; i < m; i++) {
-        garbledBloomArray[i] = 0;
+    if (!publicKey) {
+        throw std::runtime_error("GBF was constructed without a public key");
     }
-    
-    for (const auto& element : inputArray) {
-        // 加密数字1，对应Python代码中的 one = public_key.encrypt(1)
-        mpz_class one_text = publicKey.encrypt(a);
-        /*mpz_class one_text;
-	try {
-	    one_text = publicKey.encrypt(1);
-	} catch (const std::exception& e) {
-	    std::cerr << "Encryption failed: " << e.what() << std::endl;
-	    throw;
-	}*/
-
-        
-        int emptySlot = -1;
-        mpz_class finalShare = one_text;
-        
-        // 计算哈希
-        std::vector<size_t> hashPositions = computeHashes(element);
-        
-        for (size_t i = 0; i < hashPositions.size(); i++) {
+    if (mpz_sizeinbase(publicKey->get_n_squared().get_mpz_t(), 2) > getRowLimbs() * 64) {
+        throw std::runtime_error("Ciphertext does not fit in the GBF share width");
+    }
+
+    // 每个元素的 payload 密文互相独立，先在线程池中批量加密
+    std::vector<mpz_class> payloads(inputArray.size(), mpz_class(a));
+    std::vector<mpz_class> encryptedPayloads(inputArray.size());
+    publicKey->encrypt_batch(payloads.data(), payloads.size(), encryptedPayloads.data(), pool);
+
+    // 加密数字1，对应Python代码中的 one = public_key.encrypt(1)
+    const size_t limbs = getRowLimbs();
+    std::vector<uint64_t> payloadRows(inputArray.size() * limbs);
+    for (size_t e = 0; e < inputArray.size(); e++) {
+        loadRow(&payloadRows[e * limbs], limbs, encryptedPayloads[e]);
+    }
+    generate(inputArray, payloadRows.data(), pool);
+}
+
+template <size_t ShareBits>
+void BasicGarbledBloomFilter<ShareBits>::generate(const std::vector<std::string>& inputArray,
+                                                  const uint64_t* payloads, ThreadPool& pool) {
+    unsigned char freshSeed[SEED_SIZE];
+    SecureRandom::fill_bytes(freshSeed, SEED_SIZE);
+    generate(inputArray, payloads, freshSeed, pool);
+}
+
+template <size_t ShareBits>
+void BasicGarbledBloomFilter<ShareBits>::generate(const std::vector<std::string>& inputArray,
+                                                  const uint64_t* payloads, const unsigned char* seed,
+                                                  ThreadPool& pool) {
+    const size_t limbs = getRowLimbs();
+    const size_t count = inputArray.size();
+    // 初始化所有位置为空，并由 seed 展开全部随机行，之后只改写各元素最终 share 所在的行
+    std::memcpy(this->seed, seed, SEED_SIZE);
+    mapping.reset();
+    mappedRows = nullptr;
+    slab.resize((static_cast<size_t>(m) * limbs + 7) / 8);
+    slotState.assign(m, SLOT_EMPTY);
+
+    const size_t ROW_GRAIN = 4096;
+    pool.parallel_for(m, [&](size_t begin, size_t end) {
+        expandRows(begin, end - begin);
+    }, ROW_GRAIN);
+    const size_t HASH_GRAIN = 4096;
+    std::vector<size_t> positions(count * k);
+    pool.parallel_for(count, [&](size_t begin, size_t end) {
+        computePositionsBatch(inputArray.data() + begin, end - begin, &positions[begin * k]);
+    }, HASH_GRAIN);
+
+    // 调度：按元素顺序模拟逐个插入时的槽位状态变化，只读写状态字节。
+    // 元素的最终 share 槽位是其第一个仍为空的位置；其余位置中已显式写入的行来自更早的元素，
+    // 该元素的层号比所有这些元素都大，同层元素之间既不互相读取也不写同一行
+    const int NO_SLOT = -1;
+    std::vector<int> emptyIndex(count, NO_SLOT);
+    std::vector<uint32_t> level(count, 0);
+    std::vector<uint32_t> slotLevel(m, 0);
+    uint32_t levels = 0;
+    for (size_t e = 0; e < count; e++) {
+        const size_t* hashPositions = &positions[e * k];
+        uint32_t elementLevel = 0;
+        for (int i = 0; i < k; i++) {
             size_t j = hashPositions[i];
-            
-            if (garbledBloomArray[j] == 0) {
-                if (emptySlot == -1) {
-                    emptySlot = j;  // 预留空槽位用于最终的share
-                } else {
-                    mpz_class newShare = generateRandomBits(lambda);
-                    garbledBloomArray[j] = newShare;
-                    // XOR操作对应大整数的按位异或
-                    finalShare = finalShare ^ garbledBloomArray[j];
+
+            if (slotState[j] == SLOT_EMPTY) {
+                if (emptyIndex[e] == NO_SLOT) {
+                    emptyIndex[e] = i;  // 预留空槽位用于最终的share
+                    continue;
                 }
-            } else {
-                finalShare = finalShare ^ garbledBloomArray[j];
+                slotState[j] = SLOT_RANDOM;  // 已是随机值，直接作为新的share
+            } else if (slotState[j] == SLOT_EXPLICIT) {
+                elementLevel = std::max(elementLevel, slotLevel[j] + 1);
             }
         }
-        
-        // 在空槽放入最终的share
-        if (emptySlot != -1) {
-            garbledBloomArray[emptySlot] = finalShare;
+        if (emptyIndex[e] != NO_SLOT) {
+            size_t slot = hashPositions[emptyIndex[e]];
+            slotState[slot] = SLOT_EXPLICIT;
+            slotLevel[slot] = elementLevel;
+            level[e] = elementLevel;
+            levels = std::max(levels, elementLevel + 1);
         }
     }
-    
-    // 填充所有剩余的空槽
+
+    // 按层分桶（层内保持元素顺序）
+    std::vector<size_t> levelStart(levels + 1, 0);
+    for (size_t e = 0; e < count; e++) {
+        if (emptyIndex[e] != NO_SLOT) {
+            levelStart[level[e] + 1]++;
+        }
+    }
+    for (uint32_t l = 0; l < levels; l++) {
+        levelStart[l + 1] += levelStart[l];
+    }
+    std::vector<size_t> order(levelStart[levels]);
+    std::vector<size_t> fill(levelStart.begin(), levelStart.end() - 1);
+    for (size_t e = 0; e < count; e++) {
+        if (emptyIndex[e] != NO_SLOT) {
+            order[fill[level[e]]++] = e;
+        }
+    }
+
+    // 在空槽放入最终的share：payload 与其余 k-1 行的异或。
+    // Legacy 方案的位置可能重复，预留槽位再次出现时应按其种子展开值参与异或（与逐个插入时填入的随机值对应），
+    // 因此先在临时行里算好再写回，不能直接在预留槽位上累加（否则该行与自身异或抵消）
+    XorRowsFn xorRows = xorRowsKernel<ROW_LIMBS>();
+    const size_t SHARE_GRAIN = 256;
+    for (uint32_t l = 0; l < levels; l++) {
+        pool.parallel_for(levelStart[l + 1] - levelStart[l], [&](size_t begin, size_t end) {
+            std::vector<uint64_t> finalShare(limbs);
+            for (size_t idx = levelStart[l] + begin; idx < levelStart[l] + end; idx++) {
+                size_t e = order[idx];
+                const size_t* hashPositions = &positions[e * k];
+                size_t sharePositions[MAX_HASHES];
+                size_t shareCount = 0;
+                for (int i = 0; i < k; i++) {
+                    if (i != emptyIndex[e]) {
+                        sharePositions[shareCount++] = hashPositions[i];
+                    }
+                }
+                std::copy(payloads + e * limbs, payloads + (e + 1) * limbs, finalShare.begin());
+                xorRows(finalShare.data(), row(0), limbs, sharePositions, shareCount);
+                std::copy(finalShare.begin(), finalShare.end(), row(hashPositions[emptyIndex[e]]));
+            }
+        }, SHARE_GRAIN);
+    }
+    // 剩余的空槽保持种子展开的随机值
+
+    buildStats = GBFBuildStats();
+    buildStats.elements = count;
+    buildStats.slots_per_element = count > 0 ? static_cast<double>(m) / count : 0.0;
+    buildStats.empty_slot_ratio = static_cast<double>(std::count(slotState.begin(), slotState.end(), SLOT_EMPTY)) / m;
+    buildStats.failed_inserts = count - order.size();
+    buildStats.levels = levels;
+}
+
+template <size_t ShareBits>
+void BasicGarbledBloomFilter<ShareBits>::expandRows(size_t begin, size_t count) {
+    // 行宽是 16 字节的整数倍，第 begin 行从第 begin * 行宽 / 16 个 AES 块开始；CTR 计数器为大端 128 位
+    const size_t rowBytes = getRowLimbs() * sizeof(uint64_t);
+    uint64_t block = static_cast<uint64_t>(begin) * (rowBytes / 16);
+    unsigned char iv[16] = {0};
+    for (int i = 0; i < 8; i++) {
+        iv[15 - i] = static_cast<unsigned char>(block >> (8 * i));
+    }
+    AesCtrPrg prg(seed, iv);
+    prg.fill(reinterpret_cast<unsigned char*>(row(begin)), count * rowBytes);
+}
+
+template <size_t ShareBits>
+std::vector<unsigned char> BasicGarbledBloomFilter<ShareBits>::serializeCompressed() const {
+    if (slotState.empty()) {
+        throw std::runtime_error("GBF slot states are not available");
+    }
+    const size_t limbs = getRowLimbs();
+    std::vector<uint64_t> explicitRows;
     for (int i = 0; i < m; i++) {
-        if (garbledBloomArray[i] == 0) {
-            garbledBloomArray[i] = generateRandomBits(lambda);
+        if (slotState[i] == SLOT_EXPLICIT) {
+            explicitRows.push_back(static_cast<uint64_t>(i));
+            explicitRows.insert(explicitRows.end(), row(i), row(i) + limbs);
         }
     }
+
+    CompressedHeader header;
+    std::memcpy(header.magic, COMPRESSED_MAGIC, sizeof(header.magic));
+    header.version = COMPRESSED_VERSION;
+    header.endianMark = ENDIAN_MARK;
+    header.m = static_cast<uint64_t>(m);
+    header.rowLimbs = static_cast<uint32_t>(limbs);
+    header.hashScheme = static_cast<uint16_t>(hashScheme);
+    header.k = static_cast<uint16_t>(k);
+    header.explicitCount = explicitRows.size() / (limbs + 1);
+    std::memcpy(header.hashKey, hashKey, HASH_KEY_SIZE);
+    std::memcpy(header.seed, seed, SEED_SIZE);
+
+    std::vector<unsigned char> bytes(sizeof(header) + explicitRows.size() * sizeof(uint64_t));
+    std::memcpy(bytes.data(), &header, sizeof(header));
+    std::memcpy(bytes.data() + sizeof(header), explicitRows.data(), explicitRows.size() * sizeof(uint64_t));
+    return bytes;
 }
 
-mpz_class GarbledBloomFilter::query(const std::string& element) const {
-    std::vector<size_t> hashPositions = computeHashes(element);
-    
-    mpz_class recovered = 0;
-    for (const auto& j : hashPositions) {
-        recovered = recovered ^ garbledBloomArray[j];
+template <size_t ShareBits>
+BasicGarbledBloomFilter<ShareBits> BasicGarbledBloomFilter<ShareBits>::deserializeCompressed(const unsigned char* data,
+                                                                                              size_t length) {
+    CompressedHeader header;
+    if (length < sizeof(header)) {
+        throw std::runtime_error("Compressed GBF is truncated");
     }
+    std::memcpy(&header, data, sizeof(header));
+    if (std::memcmp(header.magic, COMPRESSED_MAGIC, sizeof(header.magic)) != 0 ||
+        header.version != COMPRESSED_VERSION || header.endianMark != ENDIAN_MARK) {
+        throw std::runtime_error("Not a compressed GBF of a supported version");
+    }
+    if (header.k < 1 || header.k > MAX_HASHES || (header.hashScheme == 0 && header.k != NUM_HASHES) ||
+        header.m < header.k || header.m > static_cast<uint64_t>(INT32_MAX) ||
+        header.rowLimbs == 0 || header.rowLimbs % 2 != 0 || (ROW_LIMBS == 0 && header.rowLimbs % 8 != 0) ||
+        (ROW_LIMBS != 0 && header.rowLimbs != ROW_LIMBS) || header.hashScheme > 1) {
+        throw std::runtime_error("Compressed GBF parameters do not match this filter type");
+    }
+    const size_t limbs = header.rowLimbs;
+    const size_t recordBytes = (limbs + 1) * sizeof(uint64_t);
+    if ((length - sizeof(header)) / recordBytes < header.explicitCount ||
+        length - sizeof(header) != header.explicitCount * recordBytes) {
+        throw std::runtime_error("Compressed GBF is truncated");
+    }
+
+    BasicGarbledBloomFilter filter;
+    filter.m = static_cast<int>(header.m);
+    filter.k = header.k;
+    filter.rowLimbs = limbs;
+    filter.hashScheme = static_cast<GBFHashScheme>(header.hashScheme);
+    std::memcpy(filter.hashKey, header.hashKey, HASH_KEY_SIZE);
+    std::memcpy(filter.seed, header.seed, SEED_SIZE);
+    filter.slab.resize((header.m * limbs + 7) / 8);
+    filter.slotState.assign(filter.m, SLOT_RANDOM);
+    filter.expandRows(0, filter.m);
+
+    const unsigned char* record = data + sizeof(header);
+    for (uint64_t r = 0; r < header.explicitCount; r++, record += recordBytes) {
+        uint64_t index;
+        std::memcpy(&index, record, sizeof(index));
+        if (index >= header.m) {
+            throw std::runtime_error("Compressed GBF slot index out of range");
+        }
+        std::memcpy(filter.row(index), record + sizeof(index), limbs * sizeof(uint64_t));
+        filter.slotState[index] = SLOT_EXPLICIT;
+    }
+    return filter;
+}
+
+template <size_t ShareBits>
+void BasicGarbledBloomFilter<ShareBits>::query(const std::string& element, uint64_t* out) const {
+    size_t hashPositions[MAX_HASHES];
+    computePositions(element, hashPositions);
+    
+    std::fill(out, out + getRowLimbs(), 0);
+    xorRowsKernel<ROW_LIMBS>()(out, row(0), getRowLimbs(), hashPositions, k);
+}
+
+template <size_t ShareBits>
+mpz_class BasicGarbledBloomFilter<ShareBits>::query(const std::string& element) const {
+    // 直接异或进结果的 limb 缓冲区，只分配这一次
+    mpz_class recovered;
+    mp_limb_t* limbs = mpz_limbs_write(recovered.get_mpz_t(), getRowLimbs());
+    query(element, reinterpret_cast<uint64_t*>(limbs));
+    mpz_limbs_finish(recovered.get_mpz_t(), getRowLimbs());
     //mpz_class recover = publicKey.encrypt(recovered);
     return recovered;
 }
 
+template <size_t ShareBits>
+void BasicGarbledBloomFilter<ShareBits>::queryBatch(const std::string* elements, size_t count, uint64_t* out) const {
+    const size_t limbs = getRowLimbs();
+    const size_t rowBytes = limbs * sizeof(uint64_t);
+    const uint64_t* base = row(0);
+    XorRowsFn xorRows = xorRowsKernel<ROW_LIMBS>();
+
+    // 位置缓冲区大小固定，与 computePositionsBatch 的摘要分块一致
+    const size_t CHUNK = 256;
+    size_t positions[CHUNK * MAX_HASHES];
+    for (size_t chunkBegin = 0; chunkBegin < count; chunkBegin += CHUNK) {
+        size_t chunk = std::min(CHUNK, count - chunkBegin);
+        computePositionsBatch(elements + chunkBegin, chunk, positions);
+
+        for (size_t e = 0; e < chunk + QUERY_PREFETCH_DISTANCE; e++) {
+            // 预取落后 QUERY_PREFETCH_DISTANCE 个元素的行，每行可能跨多个缓存行
+            if (e < chunk) {
+                for (int i = 0; i < k; i++) {
+                    const char* line = reinterpret_cast<const char*>(base + positions[e * k + i] * limbs);
+                    for (size_t offset = 0; offset < rowBytes; offset += sizeof(GBFLine)) {
+                        _mm_prefetch(line + offset, _MM_HINT_T0);
+                    }
+                }
+            }
+            if (e < QUERY_PREFETCH_DISTANCE) {
+                continue;
+            }
+            size_t target = e - QUERY_PREFETCH_DISTANCE;
+            uint64_t* result = out + (chunkBegin + target) * limbs;
+            std::fill(result, result + limbs, 0);
+            xorRows(result, base, limbs, &positions[target * k], k);
+        }
+    }
+}
+
+template <size_t ShareBits>
+std::vector<mpz_class> BasicGarbledBloomFilter<ShareBits>::queryBatch(const std::vector<std::string>& elements) const {
+    const size_t limbs = getRowLimbs();
+    std::vector<uint64_t> rows(elements.size() * limbs);
+    queryBatch(elements.data(), elements.size(), rows.data());
+    std::vector<mpz_class> results(elements.size());
+    for (size_t e = 0; e < elements.size(); e++) {
+        mp_limb_t* dst = mpz_limbs_write(results[e].get_mpz_t(), limbs);
+        std::copy(&rows[e * limbs], &rows[(e + 1) * limbs], dst);
+        mpz_limbs_finish(results[e].get_mpz_t(), limbs);
+    }
+    return results;
+}
+
+template class BasicGarbledBloomFilter<GBF_DYNAMIC_SHARE_BITS>;
+template class BasicGarbledBloomFilter<128>;
+template class BasicGarbledBloomFilter<256>;
+template class BasicGarbledBloomFilter<2048>;
+template class BasicGarbledBloomFilter<4096>;
@@ -2,39 +2,225 @@
 #define GARBLED_BLOOM_H
 
 #include "PaillierCrypto.h"
+#include "SecureRandom.h"
+#include "ThreadPool.h"
 #include <vector>
 #include <string>
 #include <openssl/md5.h>
 #include <openssl/sha.h>
-#include <random>
 #include <iostream>
 #include <cstring>
+#include <cstdint>
+#include <memory>
 
-class GarbledBloomFilter {
+// 元素到 k 个槽位的映射方式
+enum class GBFHashScheme : uint8_t {
+    Legacy = 0,  // md5 ... sha3_512 十种摘要各给出一个位置，与旧版本生成的 GBF 兼容
+    SHA256 = 1   // 一次 SHA-256(hashKey || element)，双重哈希展开出 k 个互不相同的位置
+};
+
+// 64 字节对齐的存储单元，GBF 的每一行占整数个 GBFLine
+struct alignas(64) GBFLine {
+    uint64_t limbs[8];
+};
+
+// getFilter() 返回的只读视图：直接指向 GBF 内部的连续存储，不复制
+// 第 i 个槽位是 row(i) 起的 rowLimbs() 个 64 位小端 limb
+class GBFView {
+public:
+    GBFView(const uint64_t* data, size_t rows, size_t rowLimbs) : base(data), rows(rows), limbsPerRow(rowLimbs) {}
+
+    size_t size() const { return rows; }
+    size_t rowLimbs() const { return limbsPerRow; }
+    const uint64_t* data() const { return base; }
+    const uint64_t* row(size_t i) const { return base + i * limbsPerRow; }
+    // 转换为大整数，仅用于调试和兼容旧接口
+    mpz_class slot(size_t i) const;
+
+private:
+    const uint64_t* base;
+    size_t rows;
+    size_t limbsPerRow;
+};
+
+// 按目标误判率选取 m 和 k 的策略
+struct GBFSizingPolicy {
+    double false_positive_rate = 1.0 / 1024;  // 集合外元素的 k 个位置全部已被占用的概率
+    size_t memory_budget = 0;                 // slab 字节数上限，0 表示不限
+};
+
+// 选取结果
+struct GBFSizing {
+    int m = 0;
+    int k = 0;
+    double expected_false_positive_rate = 0.0;  // (1 - e^(-kn/m))^k
+};
+
+// 最近一次 generate 的统计
+struct GBFBuildStats {
+    size_t elements = 0;
+    double slots_per_element = 0.0;  // m / n
+    double empty_slot_ratio = 0.0;   // 没有被任何元素使用的槽位比例
+    size_t failed_inserts = 0;       // k 个位置都已被占用、无法写入最终 share 的元素数，查询时得不到 payload
+    size_t levels = 0;               // 并行写入最终 share 的层数
+};
+
+// 与 share 宽度无关的部分：槽位个数与元素到 k 个槽位的映射
+class GarbledBloomBase {
 public:
-    GarbledBloomFilter(int numElements, const PaillierPublicKey& pubKey);
+    // 默认的每个元素位置个数，Legacy 方案固定为该值
+    static const int NUM_HASHES = 10;
+    static const int MAX_HASHES = 32;
+    static const size_t HASH_KEY_SIZE = 16;
+
+    // SHA256 模式下每个 GBF 随机选取自己的 hashKey，查询方使用同一个 GBF 对象即可得到相同位置
+    // m = 10n / 0.69，k = NUM_HASHES
+    GarbledBloomBase(int numElements, GBFHashScheme scheme);
+    GarbledBloomBase(const GBFSizing& sizing, GBFHashScheme scheme);
+
+    // k 取 log2(1/p) 附近的整数（Legacy 固定为 NUM_HASHES），m 取使 (1 - e^(-kn/m))^k 恰好不超过 p 的最小值。
+    // 给出内存上限且装不下时，m 取上限能容纳的行数，k 改为该 m 下的最优值 (m/n) ln 2；
+    // 上限连 k 行都放不下时抛出异常
+    static GBFSizing computeSizing(size_t numElements, size_t rowBytes, const GBFSizingPolicy& policy,
+                                   GBFHashScheme scheme = GBFHashScheme::SHA256);
+
+    int size() const { return m; }
+    int getNumHashes() const { return k; }
+    GBFHashScheme getHashScheme() const { return hashScheme; }
+    const unsigned char* getHashKey() const { return hashKey; }
+
+    // 计算元素的 k 个位置写入 positions，不分配堆内存
+    void computePositions(const std::string& element, size_t* positions) const;
+    // 批量计算：positions[e * k + i]，SHA256 模式下用多缓冲 SIMD SHA-256 一次处理 8/16 个元素
+    void computePositionsBatch(const std::string* elements, size_t count, size_t* positions) const;
+    std::vector<size_t> computePositionsBatch(const std::vector<std::string>& elements) const;
+
+protected:
+    // 反序列化时由派生类随后填入各字段
+    GarbledBloomBase() : m(0), k(NUM_HASHES), hashScheme(GBFHashScheme::SHA256) {}
+
+    int m; // Bloom filter大小
+    int k; // 每个元素的位置个数，不超过 MAX_HASHES
+    GBFHashScheme hashScheme;
+    unsigned char hashKey[HASH_KEY_SIZE];
+
+private:
+    // 由 SHA-256 摘要展开出 k 个互不相同的位置
+    void positionsFromDigest(const unsigned char* digest, size_t* positions) const;
+};
+
+// 运行时决定行宽：max(lambda, n^2 的位数) 向上取整到 512 位
+const size_t GBF_DYNAMIC_SHARE_BITS = 0;
+
+// ShareBits 位 share 的 GBF。行宽在编译期确定时异或循环的 limb 数为常量，可完全展开：
+//   128/256 位：只存对称密钥、MAC 等明文 payload，内存是密文宽度的 1/8 ~ 1/32
+//   2048/4096 位：1024/2048 位 Paillier 密钥的密文 payload
+// 行宽为 128/256 位时多行共享一个缓存行，512 位的整数倍时每行从缓存行边界开始
+template <size_t ShareBits>
+class BasicGarbledBloomFilter : public GarbledBloomBase {
+    static_assert(ShareBits == GBF_DYNAMIC_SHARE_BITS ||
+                      (ShareBits % 128 == 0 && (512 % ShareBits == 0 || ShareBits % 512 == 0)),
+                  "GBF share width must be 128, 256 or a multiple of 512 bits");
+
+public:
+    // 编译期行宽（limb 数），0 表示由构造时的公钥决定
+    static constexpr size_t ROW_LIMBS = ShareBits / 64;
+    // 运行时行宽下随机 share 的最小位数
+    static const int LAMBDA = 2048;
+    // 随机行由 AES-128-CTR(seed) 展开：行 i 是密钥流中从字节 i * 行宽开始的一段
+    static const size_t SEED_SIZE = AesCtrPrg::KEY_SIZE;
+
+    BasicGarbledBloomFilter(int numElements, const PaillierPublicKey& pubKey,
+                            GBFHashScheme scheme = GBFHashScheme::SHA256);
+    // 不带公钥：只能用 generate(inputArray, payloads) 存放明文 payload
+    explicit BasicGarbledBloomFilter(int numElements, GBFHashScheme scheme = GBFHashScheme::SHA256);
+    // 按 GarbledBloomBase::computeSizing 选取 m 和 k，内存上限按本 filter 的行宽计算
+    BasicGarbledBloomFilter(int numElements, const PaillierPublicKey& pubKey, const GBFSizingPolicy& policy,
+                            GBFHashScheme scheme = GBFHashScheme::SHA256);
+    BasicGarbledBloomFilter(int numElements, const GBFSizingPolicy& policy,
+                            GBFHashScheme scheme = GBFHashScheme::SHA256);
     
-    // 生成Garbled Bloom Filter
-    void generate(const std::vector<std::string>& inputArray, int a);
+    // 生成Garbled Bloom Filter，payload 为 a 的 Paillier 密文；密文超出行宽时抛出异常
+    void generate(const std::vector<std::string>& inputArray, int a, ThreadPool& pool = ThreadPool::global());
+    // payloads[e * getRowLimbs() ...] 是第 e 个元素的 payload 行
+    void generate(const std::vector<std::string>& inputArray, const uint64_t* payloads,
+                  ThreadPool& pool = ThreadPool::global());
+    // 指定 seed（SEED_SIZE 字节）：结果只由 seed 和输入决定，与线程数无关，且与按元素顺序逐个插入的结果逐字节相同。
+    // 构建分四步：并行计算位置并由 seed 展开全部行；按元素顺序单线程扫描槽位状态，确定每个元素的最终 share 槽位
+    // 及其依赖的更早写入的行，据此分层；逐层并行写入最终 share，同层元素互不依赖
+    void generate(const std::vector<std::string>& inputArray, const uint64_t* payloads, const unsigned char* seed,
+                  ThreadPool& pool = ThreadPool::global());
     
     // 查询Garbled Bloom Filter
     mpz_class query(const std::string& element) const;
+    // 不分配内存的查询：k 行异或结果写入 out（getRowLimbs() 个 limb）
+    void query(const std::string& element, uint64_t* out) const;
+    // 批量查询：out[e * getRowLimbs() ...] 为第 e 个元素的结果。先用多缓冲 SHA-256 算出一块元素的全部位置，
+    // 异或第 e 个元素时预取第 e + QUERY_PREFETCH_DISTANCE 个元素的 k 行，使随机访存相互重叠
+    void queryBatch(const std::string* elements, size_t count, uint64_t* out) const;
+    std::vector<mpz_class> queryBatch(const std::vector<std::string>& elements) const;
+
+    static const size_t QUERY_PREFETCH_DISTANCE = 8;
     
-    // 获取整个Garbled Bloom Filter
-    const std::vector<mpz_class>& getFilter() const { return garbledBloomArray; }
+    // 获取整个Garbled Bloom Filter（零拷贝视图，生命周期不超过本对象；generate 之前为空）
+    GBFView getFilter() const { return GBFView(row(0), isGenerated() ? m : 0, getRowLimbs()); }
+    bool isGenerated() const { return !slab.empty() || mappedRows != nullptr; }
+    size_t getRowLimbs() const { return ROW_LIMBS != 0 ? ROW_LIMBS : rowLimbs; }
+    // 每次 generate 重新选取
+    const unsigned char* getSeed() const { return seed; }
+    const GBFBuildStats& getBuildStats() const { return buildStats; }
+
+    // 种子压缩格式：参数、hashKey、seed，加上各元素最终 share 所在的行（不超过 n 行），
+    // 需要 generate 或 deserializeCompressed 得到的槽位状态，从 GBF 文件加载的 filter 不支持；
+    // 其余 m - n 行由接收方按 seed 重新展开。seed 会暴露哪些行是显式写入的，
+    // 进而可以检验猜测的元素是否在集合中，因此只用于发往可信方（如自身的存储或副本）；
+    // 发给查询方时应传完整的 slab
+    std::vector<unsigned char> serializeCompressed() const;
+    static BasicGarbledBloomFilter deserializeCompressed(const unsigned char* data, size_t length);
 
 private:
-    int m; // Bloom filter大小
-    int lambda; // 随机数位长度
-    std::vector<mpz_class> garbledBloomArray;
-    PaillierPublicKey publicKey;
-    
-    // 计算元素的多个哈希值
-    std::vector<size_t> computeHashes(const std::string& element) const;
-    
-    // 生成随机数
-    mpz_class generateRandomBits(int bits) const;
+    // 运行时行宽，ROW_LIMBS 非 0 时与其相等
+    size_t rowLimbs;
+    // m 行连续存放在一块 64 字节对齐的内存中；generate 时才分配
+    std::vector<GBFLine> slab;
+    // 槽位状态，取代原先以值为 0 表示空槽
+    enum SlotState : uint8_t {
+        SLOT_EMPTY = 0,     // 未被任何元素使用，内容为种子展开的随机值
+        SLOT_RANDOM = 1,    // 作为某个元素的随机 share，内容仍是种子展开值
+        SLOT_EXPLICIT = 2   // 某个元素的最终 share，序列化时必须显式传输
+    };
+    std::vector<uint8_t> slotState;
+    unsigned char seed[SEED_SIZE];
+    GBFBuildStats buildStats;
+    // 由 GarbledBloomStore::map 得到的只读映射：非空时查询直接读映射的页面，slab 和 slotState 为空；
+    // 拷贝的 filter 共享同一映射，最后一个析构时解除映射
+    std::shared_ptr<const void> mapping;
+    const uint64_t* mappedRows = nullptr;
+
+    friend class GarbledBloomStore;
+    // 明文 payload 模式下为空
+    std::shared_ptr<const PaillierPublicKey> publicKey;
+
+    BasicGarbledBloomFilter() : rowLimbs(ROW_LIMBS) { std::memset(seed, 0, SEED_SIZE); }
+
+    // 公钥为空时按 LAMBDA 位
+    static size_t rowLimbsFor(const PaillierPublicKey* pubKey);
+
+    // 由 seed 展开第 begin 行起的 count 行
+    void expandRows(size_t begin, size_t count);
+
+    uint64_t* row(size_t i) { return reinterpret_cast<uint64_t*>(slab.data()) + i * getRowLimbs(); }
+    const uint64_t* row(size_t i) const {
+        const uint64_t* rows = mappedRows != nullptr ? mappedRows : reinterpret_cast<const uint64_t*>(slab.data());
+        return rows + i * getRowLimbs();
+    }
 };
 
-#endif // GARBLED_BLOOM_H
+// 在 GarbledBloom.cpp 中显式实例化的宽度
+typedef BasicGarbledBloomFilter<GBF_DYNAMIC_SHARE_BITS> GarbledBloomFilter;
+typedef BasicGarbledBloomFilter<128> GarbledBloomFilter128;
+typedef BasicGarbledBloomFilter<256> GarbledBloomFilter256;
+typedef BasicGarbledBloomFilter<2048> GarbledBloomFilter2048;
+typedef BasicGarbledBloomFilter<4096> GarbledBloomFilter4096;
 
+#endif // GARBLED_BLOOM_H
@@ -0,0 +1,209 @@
+#include "GarbledBloomStore.h"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+
+namespace {
+
+const char GBF_FILE_MAGIC[8] = {'P', 'S', 'I', 'G', 'B', 'F', 'I', 'L'};
+const uint32_t GBF_FILE_VERSION = 1;
+const uint32_t ENDIAN_MARK = 0x01020304;
+// slab 在文件中的对齐：mmap 的起始地址按页对齐，因此映射后的每一行同样满足 64 字节对齐
+const uint64_t SLAB_ALIGNMENT = 64;
+
+struct GBFFileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t endian_mark;
+    uint64_t m;
+    uint32_t k;
+    uint32_t row_limbs;
+    uint32_t hash_scheme;
+    uint32_t reserved;
+    unsigned char hash_key[16];
+    unsigned char seed[16];  // 保留，始终为 0：seed 会暴露哪些行是显式写入的
+    uint64_t slab_offset;
+    uint64_t slab_bytes;
+    unsigned char padding[40];
+};
+
+static_assert(sizeof(GBFFileHeader) == 128, "GBF file header must be 128 bytes");
+static_assert(GarbledBloomBase::HASH_KEY_SIZE == 16, "GBF file stores a 16-byte hash key");
+
+bool write_all(int fd, const void* data, size_t len) {
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    while (len > 0) {
+        ssize_t written = ::write(fd, bytes, len);
+        if (written <= 0) {
+            return false;
+        }
+        bytes += written;
+        len -= static_cast<size_t>(written);
+    }
+    return true;
+}
+
+bool read_all(int fd, void* data, size_t len) {
+    unsigned char* bytes = static_cast<unsigned char*>(data);
+    while (len > 0) {
+        ssize_t got = ::read(fd, bytes, len);
+        if (got <= 0) {
+            return false;
+        }
+        bytes += got;
+        len -= static_cast<size_t>(got);
+    }
+    return true;
+}
+
+// 校验头部，并检查参数能否装入 BasicGarbledBloomFilter<ShareBits>
+void check_header(const GBFFileHeader& header, uint64_t file_size, size_t row_limbs_required,
+                  const std::string& path) {
+    if (std::memcmp(header.magic, GBF_FILE_MAGIC, sizeof(header.magic)) != 0 ||
+        header.version != GBF_FILE_VERSION || header.endian_mark != ENDIAN_MARK) {
+        throw std::runtime_error("Not a GBF file of a supported version: " + path);
+    }
+    if (header.k < 1 || header.k > static_cast<uint32_t>(GarbledBloomBase::MAX_HASHES) ||
+        (header.hash_scheme == 0 && header.k != static_cast<uint32_t>(GarbledBloomBase::NUM_HASHES)) ||
+        header.m < header.k ||
+        header.m > static_cast<uint64_t>(INT32_MAX) || header.hash_scheme > 1 || header.row_limbs == 0 ||
+        header.row_limbs % 2 != 0 || (row_limbs_required == 0 && header.row_limbs % 8 != 0) ||
+        (row_limbs_required != 0 && header.row_limbs != row_limbs_required)) {
+        throw std::runtime_error("GBF file parameters do not match this filter type: " + path);
+    }
+    // 先确认 m * row_limbs * 8 不会溢出，否则伪造的头部可以让很小的 slab_bytes 通过校验
+    if (header.m > UINT64_MAX / 8 / header.row_limbs) {
+        throw std::runtime_error("GBF file parameters do not match this filter type: " + path);
+    }
+    if (header.slab_offset % SLAB_ALIGNMENT != 0 || header.slab_bytes != header.m * header.row_limbs * 8 ||
+        header.slab_offset > file_size || file_size - header.slab_offset < header.slab_bytes) {
+        throw std::runtime_error("GBF file is truncated: " + path);
+    }
+}
+
+// 打开文件并读出头部，返回文件描述符
+int open_gbf_file(const std::string& path, GBFFileHeader& header, size_t row_limbs_required) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("Cannot open GBF file: " + path);
+    }
+    struct stat st;
+    if (::fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(sizeof(GBFFileHeader)) ||
+        !read_all(fd, &header, sizeof(header))) {
+        ::close(fd);
+        throw std::runtime_error("GBF file is truncated: " + path);
+    }
+    try {
+        check_header(header, static_cast<uint64_t>(st.st_size), row_limbs_required, path);
+    } catch (...) {
+        ::close(fd);
+        throw;
+    }
+    return fd;
+}
+
+}
+
+template <size_t ShareBits>
+void GarbledBloomStore::save(const std::string& path, const BasicGarbledBloomFilter<ShareBits>& filter) {
+    if (!filter.isGenerated()) {
+        throw std::runtime_error("GBF has not been generated");
+    }
+    GBFView view = filter.getFilter();
+
+    GBFFileHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, GBF_FILE_MAGIC, sizeof(header.magic));
+    header.version = GBF_FILE_VERSION;
+    header.endian_mark = ENDIAN_MARK;
+    header.m = view.size();
+    header.k = static_cast<uint32_t>(filter.getNumHashes());
+    header.row_limbs = static_cast<uint32_t>(view.rowLimbs());
+    header.hash_scheme = static_cast<uint32_t>(filter.getHashScheme());
+    std::memcpy(header.hash_key, filter.getHashKey(), sizeof(header.hash_key));
+    header.slab_offset = (sizeof(header) + SLAB_ALIGNMENT - 1) / SLAB_ALIGNMENT * SLAB_ALIGNMENT;
+    header.slab_bytes = view.size() * view.rowLimbs() * sizeof(uint64_t);
+
+    // 先写临时文件再改名，已映射旧文件的读者不受影响
+    std::string tmp_path = path + ".tmp";
+    int fd = ::open(tmp_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        throw std::runtime_error("Cannot create GBF file: " + tmp_path);
+    }
+    static const unsigned char zeros[SLAB_ALIGNMENT] = {0};
+    bool ok = write_all(fd, &header, sizeof(header)) &&
+              write_all(fd, zeros, header.slab_offset - sizeof(header)) &&
+              write_all(fd, view.data(), header.slab_bytes) && ::fsync(fd) == 0;
+    ::close(fd);
+    if (!ok || ::rename(tmp_path.c_str(), path.c_str()) != 0) {
+        ::unlink(tmp_path.c_str());
+        throw std::runtime_error("Failed to write GBF file: " + path);
+    }
+}
+
+template <size_t ShareBits>
+BasicGarbledBloomFilter<ShareBits> GarbledBloomStore::load(const std::string& path) {
+    typedef BasicGarbledBloomFilter<ShareBits> Filter;
+    GBFFileHeader header;
+    int fd = open_gbf_file(path, header, Filter::ROW_LIMBS);
+
+    Filter filter;
+    filter.m = static_cast<int>(header.m);
+    filter.k = static_cast<int>(header.k);
+    filter.rowLimbs = header.row_limbs;
+    filter.hashScheme = static_cast<GBFHashScheme>(header.hash_scheme);
+    std::memcpy(filter.hashKey, header.hash_key, sizeof(header.hash_key));
+    filter.slab.resize((header.slab_bytes + sizeof(GBFLine) - 1) / sizeof(GBFLine));
+    bool ok = ::lseek(fd, static_cast<off_t>(header.slab_offset), SEEK_SET) >= 0 &&
+              read_all(fd, filter.slab.data(), header.slab_bytes);
+    ::close(fd);
+    if (!ok) {
+        throw std::runtime_error("Failed to read GBF file: " + path);
+    }
+    return filter;
+}
+
+template <size_t ShareBits>
+BasicGarbledBloomFilter<ShareBits> GarbledBloomStore::map(const std::string& path) {
+    typedef BasicGarbledBloomFilter<ShareBits> Filter;
+    GBFFileHeader header;
+    int fd = open_gbf_file(path, header, Filter::ROW_LIMBS);
+    size_t length = static_cast<size_t>(header.slab_offset + header.slab_bytes);
+    void* address = ::mmap(nullptr, length, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (address == MAP_FAILED) {
+        throw std::runtime_error("Cannot mmap GBF file: " + path);
+    }
+    // 查询按哈希位置随机访问，关闭预读
+    ::madvise(address, length, MADV_RANDOM);
+
+    Filter filter;
+    filter.m = static_cast<int>(header.m);
+    filter.k = static_cast<int>(header.k);
+    filter.rowLimbs = header.row_limbs;
+    filter.hashScheme = static_cast<GBFHashScheme>(header.hash_scheme);
+    std::memcpy(filter.hashKey, header.hash_key, sizeof(header.hash_key));
+    filter.mapping = std::shared_ptr<const void>(address, [length](const void* p) {
+        ::munmap(const_cast<void*>(p), length);
+    });
+    filter.mappedRows = reinterpret_cast<const uint64_t*>(static_cast<const unsigned char*>(address) +
+                                                          header.slab_offset);
+    return filter;
+}
+
+#define INSTANTIATE_GBF_STORE(BITS)                                                                            \
+    template void GarbledBloomStore::save<BITS>(const std::string&, const BasicGarbledBloomFilter<BITS>&);     \
+    template BasicGarbledBloomFilter<BITS> GarbledBloomStore::load<BITS>(const std::string&);                 \
+    template BasicGarbledBloomFilter<BITS> GarbledBloomStore::map<BITS>(const std::string&);
+
+INSTANTIATE_GBF_STORE(GBF_DYNAMIC_SHARE_BITS)
+INSTANTIATE_GBF_STORE(128)
+INSTANTIATE_GBF_STORE(256)
+INSTANTIATE_GBF_STORE(2048)
+INSTANTIATE_GBF_STORE(4096)
+
+#undef INSTANTIATE_GBF_STORE
@@ -0,0 +1,27 @@
+#ifndef GARBLED_BLOOM_STORE_H
+#define GARBLED_BLOOM_STORE_H
+
+#include "GarbledBloom.h"
+#include <string>
+
+// GBF 文件（二进制，本机字节序）：
+//   头部 128 字节：magic "PSIGBFIL"、版本、字节序标记、m、k、行宽（limb 数）、哈希方案、hashKey、
+//   保留的 seed 字段（全 0）、slab 偏移与长度
+//   之后从 64 字节对齐的偏移处开始是 m 行 share，与内存中的 slab 布局完全相同
+// 文件只包含查询所需的内容，可以交给查询方：不保存槽位状态和 seed（持有 seed 即可分辨哪些行是显式写入的，
+// 从而检验猜测的元素是否在集合中），因此加载后的 filter 不能再做种子压缩序列化，需要可信存储时用 serializeCompressed
+class GarbledBloomStore {
+public:
+    template <size_t ShareBits>
+    static void save(const std::string& path, const BasicGarbledBloomFilter<ShareBits>& filter);
+
+    // 把 slab 读入内存
+    template <size_t ShareBits>
+    static BasicGarbledBloomFilter<ShareBits> load(const std::string& path);
+
+    // 只读映射整个文件，查询直接读取映射的页面，不复制、不重建；文件在 filter 存活期间不能被改写
+    template <size_t ShareBits>
+    static BasicGarbledBloomFilter<ShareBits> map(const std::string& path);
+};
+
+#endif // GARBLED_BLOOM_STORE_H
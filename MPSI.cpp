@@ -45,6 +45,22 @@ EncryptedNumber PSIOperations::queryGarbled(const mpz_class& element, const Garb
 
 }
 
+std::vector<EncryptedNumber> PSIOperations::queryGarbledBatch(const std::vector<mpz_class>& elements,
+                                                              const GarbledBloomFilter& gbf) {
+    std::vector<std::string> elem_strs;
+    elem_strs.reserve(elements.size());
+    for (const auto& element : elements) {
+        elem_strs.push_back(element.get_str());
+    }
+    std::vector<mpz_class> results = gbf.queryBatch(elem_strs);
+    std::vector<EncryptedNumber> encrypted;
+    encrypted.reserve(results.size());
+    for (const auto& result : results) {
+        encrypted.push_back(seq_public_key.encrypt(result));
+    }
+    return encrypted;
+}
+
 void PSIOperations::generateAllGBFs(int a) {
     auto start = std::chrono::high_resolution_clock::now();
     
@@ -86,17 +102,18 @@ void PSIOperations::computeIntersection() {
         // Compute beta values
         std::vector<EncryptedNumber> beta(n);
         std::cout<<85<<std::endl;
+        // 每个 GBF 对最后一个集合整体批量查询，com[j][i] 为第 i 个元素在第 j 个 GBF 上的结果
+        for (int j = 0; j < t-1; ++j) {
+            com[j] = queryGarbledBatch(data[t-1], GBFs[j]);
+        }
         for (int i = 0; i < n; ++i) {
-            EncryptedNumber x = zero;  // Initialize with zero
             std::cout<<88<<std::endl;
+            std::vector<mpz_class> terms(t-1);
             for (int j = 0; j < t-1; ++j) {
-                //std::cout<<90<<std::endl;
-                com[i][j] = queryGarbled(data[t-1][i], GBFs[j]);
-                //std::cout<<com[i][j]<<std::endl;
-                //std::cout<<92<<std::endl;
-                x = x + com[i][j];  // Sum up the results
-                //std::cout<<94<<std::endl;
+                terms[j] = com[j][i].getCiphertext();
             }
+            // Sum up the results in the Montgomery domain
+            EncryptedNumber x = EncryptedNumber(PaillierHomomorphic::sum(seq_public_key, terms), seq_public_key);
             std::cout<<96<<std::endl;
             std::cout << "x: " << seq_private_key.decrypt(x) << std::endl;  // Placeholder for printing x
             
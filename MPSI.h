@@ -36,6 +36,8 @@ private:
     void initializeData();
     void generateGarbledBloom(const std::vector<mpz_class>& input, int a);
     EncryptedNumber queryGarbled(const mpz_class& element, const GarbledBloomFilter& gbf);
+    // 一次查询一组元素：位置由多缓冲 SHA-256 批量计算，行读取带预取
+    std::vector<EncryptedNumber> queryGarbledBatch(const std::vector<mpz_class>& elements, const GarbledBloomFilter& gbf);
 };
 
 #endif // PSI_OPERATIONS_H
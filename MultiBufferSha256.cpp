@@ -0,0 +1,300 @@
+#include "MultiBufferSha256.h"
+#include <immintrin.h>
+#include <openssl/evp.h>
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+
+namespace {
+
+const uint32_t K[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2};
+
+const uint32_t INITIAL_STATE[8] = {0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+                                   0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19};
+
+const size_t MAX_LANES = 16;
+
+// 填充后的块数：消息 + 0x80 + 8 字节长度
+size_t padded_blocks(size_t length) {
+    return (length + 9 + 63) / 64;
+}
+
+uint32_t load_be32(const unsigned char* p) {
+    return (uint32_t(p[0]) << 24) | (uint32_t(p[1]) << 16) | (uint32_t(p[2]) << 8) | uint32_t(p[3]);
+}
+
+void store_be32(unsigned char* p, uint32_t value) {
+    p[0] = static_cast<unsigned char>(value >> 24);
+    p[1] = static_cast<unsigned char>(value >> 16);
+    p[2] = static_cast<unsigned char>(value >> 8);
+    p[3] = static_cast<unsigned char>(value);
+}
+
+void hash_scalar(const unsigned char* prefix, size_t prefix_length, const std::string& message,
+                 unsigned char* digest) {
+    thread_local std::unique_ptr<EVP_MD_CTX, decltype(&EVP_MD_CTX_free)> ctx(EVP_MD_CTX_new(), EVP_MD_CTX_free);
+    static EVP_MD* const md = EVP_MD_fetch(nullptr, "SHA2-256", nullptr);
+    unsigned int length = 0;
+    if (!ctx || md == nullptr || EVP_DigestInit_ex(ctx.get(), md, nullptr) != 1 ||
+        EVP_DigestUpdate(ctx.get(), prefix, prefix_length) != 1 ||
+        EVP_DigestUpdate(ctx.get(), message.data(), message.size()) != 1 ||
+        EVP_DigestFinal_ex(ctx.get(), digest, &length) != 1) {
+        throw std::runtime_error("SHA-256 computation failed");
+    }
+}
+
+// ---- AVX2：8 路 ----
+
+__attribute__((target("avx2"))) inline __m256i rotr_avx2(__m256i x, int n) {
+    return _mm256_or_si256(_mm256_srli_epi32(x, n), _mm256_slli_epi32(x, 32 - n));
+}
+
+// state 与 words 均按字优先、通道连续存放：state[j * 8 + lane]，words[(b * 16 + t) * 8 + lane]
+// 第 b 块只更新 b < blocks[lane] 的通道
+__attribute__((target("avx2"))) void compress_avx2(uint32_t* state, const uint32_t* words, const int32_t* blocks,
+                                                   size_t max_blocks) {
+    __m256i s[8];
+    for (int j = 0; j < 8; j++) {
+        s[j] = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(state + j * 8));
+    }
+    __m256i remaining = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(blocks));
+
+    for (size_t b = 0; b < max_blocks; b++) {
+        __m256i w[64];
+        for (int t = 0; t < 16; t++) {
+            w[t] = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(words + (b * 16 + t) * 8));
+        }
+        for (int t = 16; t < 64; t++) {
+            __m256i s0 = _mm256_xor_si256(_mm256_xor_si256(rotr_avx2(w[t - 15], 7), rotr_avx2(w[t - 15], 18)),
+                                          _mm256_srli_epi32(w[t - 15], 3));
+            __m256i s1 = _mm256_xor_si256(_mm256_xor_si256(rotr_avx2(w[t - 2], 17), rotr_avx2(w[t - 2], 19)),
+                                          _mm256_srli_epi32(w[t - 2], 10));
+            w[t] = _mm256_add_epi32(_mm256_add_epi32(w[t - 16], s0), _mm256_add_epi32(w[t - 7], s1));
+        }
+
+        __m256i a = s[0], bb = s[1], c = s[2], d = s[3], e = s[4], f = s[5], g = s[6], h = s[7];
+        for (int t = 0; t < 64; t++) {
+            __m256i sigma1 = _mm256_xor_si256(_mm256_xor_si256(rotr_avx2(e, 6), rotr_avx2(e, 11)), rotr_avx2(e, 25));
+            __m256i ch = _mm256_xor_si256(_mm256_and_si256(e, f), _mm256_andnot_si256(e, g));
+            __m256i t1 = _mm256_add_epi32(_mm256_add_epi32(h, sigma1),
+                                          _mm256_add_epi32(ch, _mm256_add_epi32(_mm256_set1_epi32(K[t]), w[t])));
+            __m256i sigma0 = _mm256_xor_si256(_mm256_xor_si256(rotr_avx2(a, 2), rotr_avx2(a, 13)), rotr_avx2(a, 22));
+            __m256i maj = _mm256_or_si256(_mm256_and_si256(a, bb), _mm256_and_si256(c, _mm256_or_si256(a, bb)));
+            __m256i t2 = _mm256_add_epi32(sigma0, maj);
+            h = g;
+            g = f;
+            f = e;
+            e = _mm256_add_epi32(d, t1);
+            d = c;
+            c = bb;
+            bb = a;
+            a = _mm256_add_epi32(t1, t2);
+        }
+
+        __m256i active = _mm256_cmpgt_epi32(remaining, _mm256_set1_epi32(static_cast<int>(b)));
+        __m256i out[8] = {a, bb, c, d, e, f, g, h};
+        for (int j = 0; j < 8; j++) {
+            s[j] = _mm256_blendv_epi8(s[j], _mm256_add_epi32(s[j], out[j]), active);
+        }
+    }
+
+    for (int j = 0; j < 8; j++) {
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(state + j * 8), s[j]);
+    }
+}
+
+// ---- AVX-512：16 路 ----
+
+// 全掩码的 maskz 形式与普通移位/循环移位相同，避免 GCC 12 对 _mm512_undefined_epi32 的误报
+__attribute__((target("avx512f"))) inline __m512i ror_avx512(__m512i x, int n) {
+    return _mm512_maskz_ror_epi32(0xFFFF, x, n);
+}
+
+__attribute__((target("avx512f"))) inline __m512i srli_avx512(__m512i x, int n) {
+    return _mm512_maskz_srli_epi32(0xFFFF, x, n);
+}
+
+__attribute__((target("avx512f"))) void compress_avx512(uint32_t* state, const uint32_t* words,
+                                                        const int32_t* blocks, size_t max_blocks) {
+    __m512i s[8];
+    for (int j = 0; j < 8; j++) {
+        s[j] = _mm512_loadu_si512(state + j * 16);
+    }
+    __m512i remaining = _mm512_loadu_si512(blocks);
+
+    for (size_t b = 0; b < max_blocks; b++) {
+        __m512i w[64];
+        for (int t = 0; t < 16; t++) {
+            w[t] = _mm512_loadu_si512(words + (b * 16 + t) * 16);
+        }
+        for (int t = 16; t < 64; t++) {
+            __m512i s0 = _mm512_ternarylogic_epi32(ror_avx512(w[t - 15], 7), ror_avx512(w[t - 15], 18),
+                                                   srli_avx512(w[t - 15], 3), 0x96);
+            __m512i s1 = _mm512_ternarylogic_epi32(ror_avx512(w[t - 2], 17), ror_avx512(w[t - 2], 19),
+                                                   srli_avx512(w[t - 2], 10), 0x96);
+            w[t] = _mm512_add_epi32(_mm512_add_epi32(w[t - 16], s0), _mm512_add_epi32(w[t - 7], s1));
+        }
+
+        __m512i a = s[0], bb = s[1], c = s[2], d = s[3], e = s[4], f = s[5], g = s[6], h = s[7];
+        for (int t = 0; t < 64; t++) {
+            // 0x96 为三输入异或，0xCA 为 e ? f : g，0xE8 为多数函数
+            __m512i sigma1 = _mm512_ternarylogic_epi32(ror_avx512(e, 6), ror_avx512(e, 11),
+                                                       ror_avx512(e, 25), 0x96);
+            __m512i ch = _mm512_ternarylogic_epi32(e, f, g, 0xCA);
+            __m512i t1 = _mm512_add_epi32(_mm512_add_epi32(h, sigma1),
+                                          _mm512_add_epi32(ch, _mm512_add_epi32(_mm512_set1_epi32(K[t]), w[t])));
+            __m512i sigma0 = _mm512_ternarylogic_epi32(ror_avx512(a, 2), ror_avx512(a, 13),
+                                                       ror_avx512(a, 22), 0x96);
+            __m512i maj = _mm512_ternarylogic_epi32(a, bb, c, 0xE8);
+            __m512i t2 = _mm512_add_epi32(sigma0, maj);
+            h = g;
+            g = f;
+            f = e;
+            e = _mm512_add_epi32(d, t1);
+            d = c;
+            c = bb;
+            bb = a;
+            a = _mm512_add_epi32(t1, t2);
+        }
+
+        __mmask16 active = _mm512_cmpgt_epi32_mask(remaining, _mm512_set1_epi32(static_cast<int>(b)));
+        __m512i out[8] = {a, bb, c, d, e, f, g, h};
+        for (int j = 0; j < 8; j++) {
+            s[j] = _mm512_mask_add_epi32(s[j], active, s[j], out[j]);
+        }
+    }
+
+    for (int j = 0; j < 8; j++) {
+        _mm512_storeu_si512(state + j * 16, s[j]);
+    }
+}
+
+}
+
+// MultiBufferSha256 implementation
+MultiBufferSha256::MultiBufferSha256(HashBackend backend) : backend(backend) {
+    if (!is_supported(backend)) {
+        throw std::runtime_error(std::string("Hash backend not supported on this CPU: ") + backend_name(backend));
+    }
+}
+
+size_t MultiBufferSha256::lanes() const {
+    switch (backend) {
+        case HashBackend::AVX512: return 16;
+        case HashBackend::AVX2: return 8;
+        default: return 1;
+    }
+}
+
+bool MultiBufferSha256::is_supported(HashBackend backend) {
+    switch (backend) {
+        case HashBackend::AVX512:
+            return __builtin_cpu_supports("avx512f");
+        case HashBackend::AVX2:
+            return __builtin_cpu_supports("avx2");
+        default:
+            return true;
+    }
+}
+
+HashBackend MultiBufferSha256::best_backend() {
+    static const HashBackend best = is_supported(HashBackend::AVX512) ? HashBackend::AVX512
+                                    : is_supported(HashBackend::AVX2) ? HashBackend::AVX2
+                                                                      : HashBackend::Scalar;
+    return best;
+}
+
+const char* MultiBufferSha256::backend_name(HashBackend backend) {
+    switch (backend) {
+        case HashBackend::AVX512: return "AVX-512";
+        case HashBackend::AVX2: return "AVX2";
+        default: return "Scalar";
+    }
+}
+
+void MultiBufferSha256::hash(const unsigned char* prefix, size_t prefix_length, const std::string* messages,
+                             size_t count, unsigned char* digests) const {
+    if (backend == HashBackend::Scalar) {
+        for (size_t i = 0; i < count; i++) {
+            hash_scalar(prefix, prefix_length, messages[i], digests + i * DIGEST_SIZE);
+        }
+        return;
+    }
+    size_t width = lanes();
+    for (size_t begin = 0; begin < count; begin += width) {
+        size_t group = std::min(width, count - begin);
+        hash_group(prefix, prefix_length, messages + begin, group, digests + begin * DIGEST_SIZE);
+    }
+}
+
+void MultiBufferSha256::hash_group(const unsigned char* prefix, size_t prefix_length, const std::string* messages,
+                                   size_t count, unsigned char* digests) const {
+    size_t width = lanes();
+    alignas(64) uint32_t state[8 * MAX_LANES];
+    alignas(64) uint32_t words[MAX_BLOCKS * 16 * MAX_LANES];
+    alignas(64) int32_t blocks[MAX_LANES] = {0};
+    unsigned char buffer[MAX_BLOCKS * 64];
+    size_t max_blocks = 0;
+
+    for (int j = 0; j < 8; j++) {
+        std::fill(state + j * width, state + (j + 1) * width, INITIAL_STATE[j]);
+    }
+
+    // 过长的消息留空通道，单独走标量路径
+    for (size_t lane = 0; lane < count; lane++) {
+        size_t n = padded_blocks(prefix_length + messages[lane].size());
+        if (n > MAX_BLOCKS) {
+            hash_scalar(prefix, prefix_length, messages[lane], digests + lane * DIGEST_SIZE);
+            continue;
+        }
+        blocks[lane] = static_cast<int32_t>(n);
+        max_blocks = std::max(max_blocks, n);
+    }
+    std::memset(words, 0, max_blocks * 16 * width * sizeof(uint32_t));
+
+    // 每条消息在本地填充后按字转置到各自的通道
+    for (size_t lane = 0; lane < count; lane++) {
+        size_t n = static_cast<size_t>(blocks[lane]);
+        if (n == 0) {
+            continue;
+        }
+        size_t length = prefix_length + messages[lane].size();
+        std::memset(buffer, 0, n * 64);
+        if (prefix_length > 0) {
+            std::memcpy(buffer, prefix, prefix_length);
+        }
+        std::memcpy(buffer + prefix_length, messages[lane].data(), messages[lane].size());
+        buffer[length] = 0x80;
+        uint64_t bit_length = static_cast<uint64_t>(length) * 8;
+        for (int i = 0; i < 8; i++) {
+            buffer[n * 64 - 1 - i] = static_cast<unsigned char>(bit_length >> (8 * i));
+        }
+        for (size_t t = 0; t < n * 16; t++) {
+            words[t * width + lane] = load_be32(buffer + t * 4);
+        }
+    }
+
+    if (backend == HashBackend::AVX512) {
+        compress_avx512(state, words, blocks, max_blocks);
+    } else {
+        compress_avx2(state, words, blocks, max_blocks);
+    }
+
+    for (size_t lane = 0; lane < count; lane++) {
+        if (blocks[lane] == 0) {
+            continue;
+        }
+        for (int j = 0; j < 8; j++) {
+            store_be32(digests + lane * DIGEST_SIZE + j * 4, state[j * width + lane]);
+        }
+    }
+}
@@ -0,0 +1,45 @@
+#ifndef MULTI_BUFFER_SHA256_H
+#define MULTI_BUFFER_SHA256_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// 多缓冲 SHA-256 的实现方式，按运行时检测到的 CPU 特性选择
+enum class HashBackend {
+    Scalar,  // 逐条 EVP 摘要（OpenSSL 内部可能使用 SHA-NI）
+    AVX2,    // 8 路
+    AVX512   // 16 路，vprord + vpternlogd
+};
+
+// 一批消息各自求 SHA-256(prefix || message)：每个 SIMD 通道承载一条消息，
+// 所有通道同步执行压缩函数，块数较少的通道提前结束后保持状态不变
+class MultiBufferSha256 {
+public:
+    static const size_t DIGEST_SIZE = 32;
+    // 填充后超过该块数的消息单独走标量路径
+    static const size_t MAX_BLOCKS = 4;
+
+    // 请求的后端 CPU 不支持时抛出异常
+    explicit MultiBufferSha256(HashBackend backend = best_backend());
+
+    // digests[i * DIGEST_SIZE ...] = SHA-256(prefix || messages[i])
+    void hash(const unsigned char* prefix, size_t prefix_length, const std::string* messages, size_t count,
+              unsigned char* digests) const;
+
+    HashBackend get_backend() const { return backend; }
+    size_t lanes() const;
+
+    static bool is_supported(HashBackend backend);
+    // 支持 AVX-512 时用 16 路，其次 AVX2，否则标量
+    static HashBackend best_backend();
+    static const char* backend_name(HashBackend backend);
+
+private:
+    HashBackend backend;
+
+    void hash_group(const unsigned char* prefix, size_t prefix_length, const std::string* messages, size_t count,
+                    unsigned char* digests) const;
+};
+
+#endif // MULTI_BUFFER_SHA256_H
@@ -1,12 +1,22 @@
 #include "PaillierCrypto.h"
+#include "PaillierKeyGen.h"
+#include "PaillierKeyStore.h"
+#include "PaillierMultiBuffer.h"
+#include "SecureRandom.h"
+#include <algorithm>
 #include <iostream>
 #include <cmath>
 #include <NTL/ZZ.h>
+#include <unistd.h>
 
 // PaillierPublicKey implementation
 PaillierPublicKey::PaillierPublicKey(const mpz_class& n) : n(n) {
     n_squared = n * n;
     g = n + 1; // 在Paillier系统中，通常g = n + 1是最简单的选择
+    if (mpz_size(n_squared.get_mpz_t()) <= MontgomeryContext::MAX_LIMBS) {
+        montgomery = std::make_shared<MontgomeryContext>(n_squared);
+    }
+    n_plan = std::make_shared<FixedExponentPlan>(n);
 }
 
 mpz_class PaillierPublicKey::encrypt(const mpz_class& message, const mpz_class& r) const {
@@ -14,6 +24,19 @@ mpz_class PaillierPublicKey::encrypt(const mpz_class& message, const mpz_class&
         throw std::runtime_error("Message is too large for the key modulus");
     }
     
+    if (r == 0 && random_pool) {
+        // 随机因子已预计算，只需一次模乘
+        mpz_class c = g_pow(message) * random_pool->take();
+        mpz_mod(c.get_mpz_t(), c.get_mpz_t(), n_squared.get_mpz_t());
+        return c;
+    }
+    
+    if (r == 0 && fixed_base) {
+        mpz_class c = g_pow(message) * fixed_base->random_rn();
+        mpz_mod(c.get_mpz_t(), c.get_mpz_t(), n_squared.get_mpz_t());
+        return c;
+    }
+    
     mpz_class random_r = r;
     if (r == 0) {
         // 如果没有提供随机数，则生成一个
@@ -25,8 +48,7 @@ mpz_class PaillierPublicKey::encrypt(const mpz_class& message, const mpz_class&
 
 mpz_class PaillierPublicKey::encrypt_raw(const mpz_class& message, const mpz_class& r) const {
     // 加密: g^m * r^n mod n^2
-    mpz_class g_m;
-    mpz_powm(g_m.get_mpz_t(), g.get_mpz_t(), message.get_mpz_t(), n_squared.get_mpz_t());
+    mpz_class g_m = g_pow(message);
     
     mpz_class r_n;
     mpz_powm(r_n.get_mpz_t(), r.get_mpz_t(), n.get_mpz_t(), n_squared.get_mpz_t());
@@ -35,10 +57,159 @@ mpz_class PaillierPublicKey::encrypt_raw(const mpz_class& message, const mpz_cla
     return c;
 }
 
+mpz_class PaillierPublicKey::g_pow(const mpz_class& message) const {
+    // (n + 1)^m = 1 + m*n (mod n^2)，负数先约化到 [0, n)，不需要负指数求逆
+    mpz_class g_m;
+    mpz_mod(g_m.get_mpz_t(), message.get_mpz_t(), n.get_mpz_t());
+    g_m *= n;
+    g_m += 1;
+    return g_m;
+}
+
+void PaillierPublicKey::encrypt_batch(const mpz_class* messages, size_t count, mpz_class* out,
+                                      ThreadPool& pool) const {
+    if (random_pool || fixed_base) {
+        // 随机因子已有更便宜的来源，逐个加密即可
+        pool.parallel_for(count, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++) {
+                out[i] = encrypt(messages[i]);
+            }
+        });
+        return;
+    }
+
+    // 所有 r^n 共享模数 n^2 和指数 n，按 SIMD 通道数分组做多缓冲模幂
+    MultiBufferModExp modexp(n_squared);
+    pool.parallel_for(count, [&](size_t begin, size_t end) {
+        std::vector<mpz_class> r_n(end - begin);
+        for (size_t i = begin; i < end; i++) {
+            if (messages[i] >= n) {
+                throw std::runtime_error("Message is too large for the key modulus");
+            }
+            r_n[i - begin] = PaillierUtil::random_r(n);
+        }
+        modexp.pow(r_n.data(), r_n.size(), *n_plan, r_n.data());
+        for (size_t i = begin; i < end; i++) {
+            out[i] = g_pow(messages[i]) * r_n[i - begin];
+            mpz_mod(out[i].get_mpz_t(), out[i].get_mpz_t(), n_squared.get_mpz_t());
+        }
+    }, modexp.lanes());
+}
+
+std::vector<mpz_class> PaillierPublicKey::encrypt_batch(const std::vector<mpz_class>& messages) const {
+    std::vector<mpz_class> out(messages.size());
+    encrypt_batch(messages.data(), messages.size(), out.data());
+    return out;
+}
+
 int PaillierPublicKey::get_bit_length() const {
     return mpz_sizeinbase(n.get_mpz_t(), 2);
 }
 
+void PaillierPublicKey::enable_random_pool(const RandomPoolConfig& config) {
+    // 生成函数只捕获 n 和 n^2，避免池与公钥互相持有
+    mpz_class modulus = n;
+    mpz_class modulus_squared = n_squared;
+    if (fixed_base) {
+        std::shared_ptr<const PaillierFixedBaseTable> table = fixed_base;
+        random_pool = std::make_shared<PaillierRandomPool>(
+            [table]() { return table->random_rn(); }, config);
+        return;
+    }
+    random_pool = std::make_shared<PaillierRandomPool>(
+        [modulus, modulus_squared]() {
+            mpz_class r = PaillierUtil::random_r(modulus);
+            mpz_class r_n;
+            mpz_powm(r_n.get_mpz_t(), r.get_mpz_t(), modulus.get_mpz_t(), modulus_squared.get_mpz_t());
+            return r_n;
+        },
+        config);
+}
+
+void PaillierPublicKey::enable_fixed_base(const FixedBaseConfig& config) {
+    fixed_base = std::make_shared<const PaillierFixedBaseTable>(n, config);
+}
+
+// PaillierFixedBaseTable implementation
+PaillierFixedBaseTable::PaillierFixedBaseTable(const mpz_class& n, const FixedBaseConfig& config)
+    : window_bits(config.window_bits), exponent_bits(config.exponent_bits) {
+    if (window_bits < 1 || window_bits > 16) {
+        throw std::runtime_error("Fixed-base window must be between 1 and 16 bits");
+    }
+    if (exponent_bits <= 0) {
+        exponent_bits = default_exponent_bits(mpz_sizeinbase(n.get_mpz_t(), 2));
+    }
+    num_windows = (exponent_bits + window_bits - 1) / window_bits;
+    n_squared = n * n;
+
+    // h = x^n mod n^2，x 为随机选取的 Z_n^* 元素
+    mpz_class x = PaillierUtil::random_r(n);
+    mpz_powm(h.get_mpz_t(), x.get_mpz_t(), n.get_mpz_t(), n_squared.get_mpz_t());
+
+    size_t row = size_t(1) << window_bits;
+    table.resize(num_windows * row);
+    mpz_class base = h;  // h^(2^(w*i))
+    for (int i = 0; i < num_windows; i++) {
+        mpz_class* entries = &table[i * row];
+        entries[0] = 1;
+        for (size_t d = 1; d < row; d++) {
+            entries[d] = (entries[d - 1] * base) % n_squared;
+        }
+        base = (entries[row - 1] * base) % n_squared;
+    }
+}
+
+mpz_class PaillierFixedBaseTable::pow(const mpz_class& alpha) const {
+    size_t row = size_t(1) << window_bits;
+    mpz_class result = 1;
+    bool first = true;
+
+    for (int i = 0; i < num_windows; i++) {
+        size_t digit = 0;
+        for (int b = 0; b < window_bits; b++) {
+            digit |= static_cast<size_t>(mpz_tstbit(alpha.get_mpz_t(), i * window_bits + b)) << b;
+        }
+        if (digit == 0) {
+            continue;
+        }
+        if (first) {
+            result = table[i * row + digit];
+            first = false;
+        } else {
+            result *= table[i * row + digit];
+            mpz_mod(result.get_mpz_t(), result.get_mpz_t(), n_squared.get_mpz_t());
+        }
+    }
+    return result;
+}
+
+mpz_class PaillierFixedBaseTable::random_rn() const {
+    mpz_class alpha = SecureRandom::random_bits(exponent_bits);
+    return pow(alpha);
+}
+
+size_t PaillierFixedBaseTable::memory_bytes() const {
+    size_t bytes = 0;
+    for (const auto& entry : table) {
+        bytes += mpz_size(entry.get_mpz_t()) * sizeof(mp_limb_t);
+    }
+    return bytes;
+}
+
+int PaillierFixedBaseTable::default_exponent_bits(int modulus_bits) {
+    // 短指数取两倍安全强度：1024 -> 80 位，2048 -> 112 位，3072 -> 128 位
+    if (modulus_bits <= 1024) {
+        return 160;
+    }
+    if (modulus_bits <= 2048) {
+        return 224;
+    }
+    if (modulus_bits <= 3072) {
+        return 256;
+    }
+    return 320;
+}
+
 // PaillierPrivateKey implementation
 PaillierPrivateKey::PaillierPrivateKey(const mpz_class& p, const mpz_class& q) 
     : p(p), q(q) {
@@ -46,6 +217,8 @@ PaillierPrivateKey::PaillierPrivateKey(const mpz_class& p, const mpz_class& q)
     n_squared = n * n;
     compute_lambda();
     compute_mu();
+    compute_crt();
+    compute_plans();
 }
 
 void PaillierPrivateKey::compute_lambda() {
@@ -67,7 +240,168 @@ void PaillierPrivateKey::compute_mu() {
     mu = PaillierUtil::invert(L_g_lambda, n);
 }
 
-mpz_class PaillierPrivateKey::decrypt(const mpz_class& ciphertext) const {
+// 由 x = c^(prime-1) mod prime^2 得到 m mod prime = L_prime(x) * h mod prime
+static mpz_class finish_crt_half(mpz_class x, const mpz_class& prime, const mpz_class& h) {
+    // L_prime(x) = (x - 1) / prime，x ≡ 1 (mod prime)，因此可以使用精确除法
+    x -= 1;
+    mpz_divexact(x.get_mpz_t(), x.get_mpz_t(), prime.get_mpz_t());
+
+    x *= h;
+    mpz_mod(x.get_mpz_t(), x.get_mpz_t(), prime.get_mpz_t());
+    return x;
+}
+
+// CRT 的一半：在 prime^2 下计算 m mod prime = L_prime(c^(prime-1) mod prime^2) * h mod prime
+static mpz_class decrypt_crt_half(const mpz_class& ciphertext, const mpz_class& prime,
+                                  const mpz_class& prime_squared, const mpz_class& prime_minus_1,
+                                  const mpz_class& h) {
+    mpz_class x;
+    mpz_mod(x.get_mpz_t(), ciphertext.get_mpz_t(), prime_squared.get_mpz_t());
+    mpz_powm(x.get_mpz_t(), x.get_mpz_t(), prime_minus_1.get_mpz_t(), prime_squared.get_mpz_t());
+    return finish_crt_half(x, prime, h);
+}
+
+void PaillierPrivateKey::compute_crt() {
+    p_squared = p * p;
+    q_squared = q * q;
+    p_minus_1 = p - 1;
+    q_minus_1 = q - 1;
+
+    // g = n + 1，hp = L_p(g^(p-1) mod p^2)^(-1) mod p，hq 同理
+    mpz_class g = n + 1;
+    mpz_class g_p, g_q;
+    mpz_powm(g_p.get_mpz_t(), g.get_mpz_t(), p_minus_1.get_mpz_t(), p_squared.get_mpz_t());
+    mpz_powm(g_q.get_mpz_t(), g.get_mpz_t(), q_minus_1.get_mpz_t(), q_squared.get_mpz_t());
+
+    g_p -= 1;
+    mpz_divexact(g_p.get_mpz_t(), g_p.get_mpz_t(), p.get_mpz_t());
+    g_q -= 1;
+    mpz_divexact(g_q.get_mpz_t(), g_q.get_mpz_t(), q.get_mpz_t());
+
+    hp = PaillierUtil::invert(g_p, p);
+    hq = PaillierUtil::invert(g_q, q);
+    q_inv_p = PaillierUtil::invert(q, p);
+
+    // Z_{p^2}^* 的阶为 p(p-1)，指数 n 可以先约化
+    n_mod_phi_p_squared = n % (p * p_minus_1);
+    n_mod_phi_q_squared = n % (q * q_minus_1);
+    q_squared_inv = PaillierUtil::invert(q_squared, p_squared);
+}
+
+void PaillierPrivateKey::compute_plans() {
+    p_minus_1_plan = std::make_shared<FixedExponentPlan>(p_minus_1);
+    q_minus_1_plan = std::make_shared<FixedExponentPlan>(q_minus_1);
+}
+
+mpz_class PaillierPrivateKey::encrypt(const mpz_class& message, const mpz_class& r) const {
+    if (message >= n) {
+        throw std::runtime_error("Message is too large for the key modulus");
+    }
+
+    mpz_class r_p, r_q;
+    if (r == 0) {
+        // r^n mod p^2 在 Z_{p^2}^* 的 p-1 阶子群上均匀分布，x^p（x 随机）的分布相同，
+        // 因此直接分别取 x_p^p mod p^2 与 x_q^q mod q^2，指数长度只有 n 的一半
+        mpz_class x_p = PaillierUtil::random_r(p_squared);
+        mpz_class x_q = PaillierUtil::random_r(q_squared);
+        mpz_powm(r_p.get_mpz_t(), x_p.get_mpz_t(), p.get_mpz_t(), p_squared.get_mpz_t());
+        mpz_powm(r_q.get_mpz_t(), x_q.get_mpz_t(), q.get_mpz_t(), q_squared.get_mpz_t());
+    } else {
+        // 指定 r 时结果与公钥加密完全一致：r^n mod p^2 与 r^n mod q^2
+        mpz_mod(r_p.get_mpz_t(), r.get_mpz_t(), p_squared.get_mpz_t());
+        mpz_powm(r_p.get_mpz_t(), r_p.get_mpz_t(), n_mod_phi_p_squared.get_mpz_t(), p_squared.get_mpz_t());
+        mpz_mod(r_q.get_mpz_t(), r.get_mpz_t(), q_squared.get_mpz_t());
+        mpz_powm(r_q.get_mpz_t(), r_q.get_mpz_t(), n_mod_phi_q_squared.get_mpz_t(), q_squared.get_mpz_t());
+    }
+
+    // Garner 合并：r^n mod n^2 = r_q + q^2 * ((r_p - r_q) * (q^2)^(-1) mod p^2)
+    mpz_class h = (r_p - r_q) * q_squared_inv;
+    mpz_mod(h.get_mpz_t(), h.get_mpz_t(), p_squared.get_mpz_t());
+    mpz_class r_n = r_q + h * q_squared;
+
+    // g^m = 1 + (m mod n) * n
+    mpz_class g_m;
+    mpz_mod(g_m.get_mpz_t(), message.get_mpz_t(), n.get_mpz_t());
+    g_m = g_m * n + 1;
+
+    mpz_class c = g_m * r_n;
+    mpz_mod(c.get_mpz_t(), c.get_mpz_t(), n_squared.get_mpz_t());
+    return c;
+}
+
+mpz_class PaillierPrivateKey::decrypt(const mpz_class& ciphertext, DecryptMode mode) const {
+    if (mode == DecryptMode::Reference) {
+        return decrypt_reference(ciphertext);
+    }
+    return decrypt_crt(ciphertext);
+}
+
+mpz_class PaillierPrivateKey::decrypt_crt(const mpz_class& ciphertext) const {
+    // 分别在 p^2 和 q^2 下解密，再用 Garner 公式合并：
+    // m = mq + ((mp - mq) * q^(-1) mod p) * q
+    mpz_class mp = decrypt_crt_half(ciphertext, p, p_squared, p_minus_1, hp);
+    mpz_class mq = decrypt_crt_half(ciphertext, q, q_squared, q_minus_1, hq);
+
+    mpz_class h = (mp - mq) * q_inv_p;
+    mpz_mod(h.get_mpz_t(), h.get_mpz_t(), p.get_mpz_t());
+
+    return mq + h * q;
+}
+
+mpz_class PaillierPrivateKey::decrypt_small(const mpz_class& ciphertext) const {
+    // |m| < p/2 时 m mod p 唯一确定 m，只需要 CRT 中 p 的一半
+    mpz_class mp = decrypt_crt_half(ciphertext, p, p_squared, p_minus_1, hp);
+
+    // 映射到 (-p/2, p/2]
+    if (2 * mp > p) {
+        mp -= p;
+    }
+    return mp;
+}
+
+void PaillierPrivateKey::decrypt_batch(const mpz_class* ciphertexts, size_t count, mpz_class* out,
+                                       ThreadPool& pool) const {
+    // c^(p-1) mod p^2 与 c^(q-1) mod q^2 分别按 SIMD 通道数分组做多缓冲模幂
+    MultiBufferModExp modexp_p(p_squared);
+    MultiBufferModExp modexp_q(q_squared);
+    pool.parallel_for(count, [&](size_t begin, size_t end) {
+        std::vector<mpz_class> xp(ciphertexts + begin, ciphertexts + end);
+        std::vector<mpz_class> xq(ciphertexts + begin, ciphertexts + end);
+        modexp_p.pow(xp.data(), xp.size(), *p_minus_1_plan, xp.data());
+        modexp_q.pow(xq.data(), xq.size(), *q_minus_1_plan, xq.data());
+        for (size_t i = begin; i < end; i++) {
+            mpz_class mp = finish_crt_half(xp[i - begin], p, hp);
+            mpz_class mq = finish_crt_half(xq[i - begin], q, hq);
+            mpz_class h = (mp - mq) * q_inv_p;
+            mpz_mod(h.get_mpz_t(), h.get_mpz_t(), p.get_mpz_t());
+            out[i] = mq + h * q;
+        }
+    }, modexp_p.lanes());
+}
+
+std::vector<mpz_class> PaillierPrivateKey::decrypt_batch(const std::vector<mpz_class>& ciphertexts) const {
+    std::vector<mpz_class> out(ciphertexts.size());
+    decrypt_batch(ciphertexts.data(), ciphertexts.size(), out.data());
+    return out;
+}
+
+void PaillierPrivateKey::decrypt_small_batch(const mpz_class* ciphertexts, size_t count, mpz_class* out,
+                                             ThreadPool& pool) const {
+    MultiBufferModExp modexp_p(p_squared);
+    pool.parallel_for(count, [&](size_t begin, size_t end) {
+        std::vector<mpz_class> xp(ciphertexts + begin, ciphertexts + end);
+        modexp_p.pow(xp.data(), xp.size(), *p_minus_1_plan, xp.data());
+        for (size_t i = begin; i < end; i++) {
+            mpz_class mp = finish_crt_half(xp[i - begin], p, hp);
+            if (2 * mp > p) {
+                mp -= p;
+            }
+            out[i] = mp;
+        }
+    }, modexp_p.lanes());
+}
+
+mpz_class PaillierPrivateKey::decrypt_reference(const mpz_class& ciphertext) const {
     // 解密: L(c^lambda mod n^2) * mu mod n
     // 其中 L(x) = (x - 1) / n
     
@@ -82,6 +416,10 @@ mpz_class PaillierPrivateKey::decrypt(const mpz_class& ciphertext) const {
 
 // PaillierKeyPair implementation
 PaillierKeyPair PaillierKeyPair::generate(int bits) {
+    return PaillierKeyGen::generate(bits);
+}
+
+PaillierKeyPair PaillierKeyPair::generate_serial(int bits) {
     // 为了安全性，每个素数应该是密钥长度的一半
     int prime_size = bits / 2;
     
@@ -99,6 +437,28 @@ PaillierKeyPair PaillierKeyPair::generate(int bits) {
     return PaillierKeyPair(public_key, private_key);
 }
 
+void PaillierKeyPair::save(const std::string& path) const {
+    PaillierKeyStore::save(path, *this);
+}
+
+PaillierKeyPair PaillierKeyPair::load(const std::string& path) {
+    return PaillierKeyStore::load(path);
+}
+
+PaillierKeyPair PaillierKeyPair::load_or_generate(const std::string& path, int bits) {
+    if (access(path.c_str(), F_OK) == 0) {
+        PaillierKeyPair key_pair = load(path);
+        if (key_pair.get_public_key().get_bit_length() == bits) {
+            return key_pair;
+        }
+    }
+
+    // 文件不存在或位长不同：重新生成并覆盖
+    PaillierKeyPair key_pair = generate(bits);
+    key_pair.save(path);
+    return key_pair;
+}
+
 // PaillierHomomorphic implementation
 mpz_class PaillierHomomorphic::add(const PaillierPublicKey& public_key, 
                                   const mpz_class& encrypted_a, 
@@ -109,9 +469,7 @@ mpz_class PaillierHomomorphic::add(const PaillierPublicKey& public_key,
 mpz_class PaillierHomomorphic::add_plain(const PaillierPublicKey& public_key, 
                                         const mpz_class& encrypted_a, 
                                         const mpz_class& plain_b) {
-    mpz_class g_b;
-    mpz_powm(g_b.get_mpz_t(), public_key.get_g().get_mpz_t(), 
-             plain_b.get_mpz_t(), public_key.get_n_squared().get_mpz_t());
+    mpz_class g_b = public_key.g_pow(plain_b);
     
     return (encrypted_a * g_b) % public_key.get_n_squared();
 }
@@ -126,15 +484,120 @@ mpz_class PaillierHomomorphic::multiply_scalar(const PaillierPublicKey& public_k
     return result;
 }
 
+mpz_class PaillierHomomorphic::sum(const PaillierPublicKey& public_key,
+                                  const mpz_class* ciphertexts,
+                                  size_t count) {
+    std::shared_ptr<const MontgomeryContext> ctx = public_key.get_montgomery();
+    if (ctx) {
+        return ctx->product(ciphertexts, count);
+    }
+    mpz_class result = 1;
+    for (size_t i = 0; i < count; i++) {
+        result *= ciphertexts[i];
+        mpz_mod(result.get_mpz_t(), result.get_mpz_t(), public_key.get_n_squared().get_mpz_t());
+    }
+    return result;
+}
+
+mpz_class PaillierHomomorphic::sum(const PaillierPublicKey& public_key,
+                                  const std::vector<mpz_class>& ciphertexts) {
+    return sum(public_key, ciphertexts.data(), ciphertexts.size());
+}
+
+mpz_class PaillierHomomorphic::linear_combination(const PaillierPublicKey& public_key,
+                                                 const mpz_class* const* ciphertexts,
+                                                 const mpz_class* scalars,
+                                                 size_t count) {
+    const size_t SMALL_SCALAR_BITS = 32;
+    const mpz_class& n_squared = public_key.get_n_squared();
+
+    // 合并同一密文的标量，去掉为 0 的项
+    std::vector<const mpz_class*> bases;
+    std::vector<mpz_class> exponents;
+    for (size_t i = 0; i < count; i++) {
+        size_t j = 0;
+        while (j < bases.size() && bases[j] != ciphertexts[i]) {
+            j++;
+        }
+        if (j == bases.size()) {
+            bases.push_back(ciphertexts[i]);
+            exponents.push_back(scalars[i]);
+        } else {
+            exponents[j] += scalars[i];
+        }
+    }
+    // 标量拆成符号和绝对值，mpz_tstbit 对负数按补码取位
+    size_t terms = 0;
+    size_t max_bits = 0;
+    std::vector<int> signs(bases.size());
+    for (size_t i = 0; i < bases.size(); i++) {
+        if (exponents[i] != 0) {
+            bases[terms] = bases[i];
+            signs[terms] = (exponents[i] < 0) ? 1 : 0;
+            mpz_abs(exponents[terms].get_mpz_t(), exponents[i].get_mpz_t());
+            max_bits = std::max(max_bits, mpz_sizeinbase(exponents[terms].get_mpz_t(), 2));
+            terms++;
+        }
+    }
+
+    mpz_class result;
+    if (terms == 0) {
+        return 1;
+    }
+    if (terms == 1 && max_bits > SMALL_SCALAR_BITS) {
+        if (signs[0]) {
+            exponents[0] = -exponents[0];
+        }
+        mpz_powm(result.get_mpz_t(), bases[0]->get_mpz_t(), exponents[0].get_mpz_t(), n_squared.get_mpz_t());
+        return result;
+    }
+
+    // 正、负标量各用一个累加器，按位从高到低同时平方-乘
+    mpz_class acc[2];
+    bool is_one[2] = {true, true};
+    for (size_t bit = max_bits; bit-- > 0;) {
+        for (int s = 0; s < 2; s++) {
+            if (!is_one[s]) {
+                acc[s] *= acc[s];
+                mpz_mod(acc[s].get_mpz_t(), acc[s].get_mpz_t(), n_squared.get_mpz_t());
+            }
+        }
+        for (size_t i = 0; i < terms; i++) {
+            if (!mpz_tstbit(exponents[i].get_mpz_t(), bit)) {
+                continue;
+            }
+            int s = signs[i];
+            if (is_one[s]) {
+                mpz_mod(acc[s].get_mpz_t(), bases[i]->get_mpz_t(), n_squared.get_mpz_t());
+                is_one[s] = false;
+            } else {
+                acc[s] *= *bases[i];
+                mpz_mod(acc[s].get_mpz_t(), acc[s].get_mpz_t(), n_squared.get_mpz_t());
+            }
+        }
+    }
+
+    if (is_one[1]) {
+        return acc[0];
+    }
+    if (mpz_invert(acc[1].get_mpz_t(), acc[1].get_mpz_t(), n_squared.get_mpz_t()) == 0) {
+        throw std::runtime_error("Ciphertext is not invertible");
+    }
+    if (is_one[0]) {
+        return acc[1];
+    }
+    result = acc[0] * acc[1];
+    mpz_mod(result.get_mpz_t(), result.get_mpz_t(), n_squared.get_mpz_t());
+    return result;
+}
+
 // PaillierUtil implementation
 mpz_class PaillierUtil::generate_prime(int bits) {
     // 使用GMP库生成质数
     mpz_class prime;
-    gmp_randclass rand(gmp_randinit_default);
-    rand.seed(time(NULL) + clock());
     
     do {
-        prime = rand.get_z_bits(bits);
+        prime = SecureRandom::random_bits(bits);
         mpz_nextprime(prime.get_mpz_t(), prime.get_mpz_t());
     } while (mpz_sizeinbase(prime.get_mpz_t(), 2) != static_cast<size_t>(bits));
     
@@ -155,12 +618,9 @@ mpz_class PaillierUtil::lcm(const mpz_class& a, const mpz_class& b) {
 }
 
 mpz_class PaillierUtil::random_r(const mpz_class& n) {
-    gmp_randclass rand(gmp_randinit_default);
-    rand.seed(time(NULL) + clock());
-    
     mpz_class r;
     do {
-        r = rand.get_z_range(n);
+        r = SecureRandom::random_below(n);
     } while (!is_coprime(r, n));
     
     return r;
@@ -3,45 +3,152 @@
 
 #include <gmpxx.h>
 #include <NTL/ZZ.h>
+#include <memory>
 #include <string>
 #include <vector>
-#include <random>
-#include <ctime>
+#include "PaillierMontgomery.h"
+#include "PaillierRandomPool.h"
+#include "ThreadPool.h"
+
+class PaillierKeyStore;
+
+// 固定基表配置
+struct FixedBaseConfig {
+    int window_bits = 6;     // 每个窗口的位数：越大表越大，加密所需乘法越少
+    int exponent_bits = 0;   // 短指数 alpha 的位长，0 表示按模数长度取默认值
+};
+
+// 固定基窗口表：h = x^n mod n^2，加密随机因子取 h^alpha（alpha 为短随机指数）
+// table[i][d] = h^(d * 2^(w*i))，计算 h^alpha 只需 ceil(alpha_bits / w) 次模乘，不需要平方
+class PaillierFixedBaseTable {
+public:
+    PaillierFixedBaseTable(const mpz_class& n, const FixedBaseConfig& config = FixedBaseConfig());
+
+    // h^alpha mod n^2，alpha 不超过 exponent_bits 位
+    mpz_class pow(const mpz_class& alpha) const;
+    // 随机选取 alpha，返回 h^alpha mod n^2
+    mpz_class random_rn() const;
+
+    int get_window_bits() const { return window_bits; }
+    int get_exponent_bits() const { return exponent_bits; }
+    size_t memory_bytes() const;
+
+    // 按模数长度给出短指数位长（约为两倍的安全强度）
+    static int default_exponent_bits(int modulus_bits);
+
+private:
+    friend class PaillierKeyStore;
+    PaillierFixedBaseTable() = default;
+
+    mpz_class n_squared;
+    mpz_class h;
+    int window_bits;
+    int exponent_bits;
+    int num_windows;
+    std::vector<mpz_class> table;  // 大小 num_windows * 2^w，按窗口连续存放
+};
 
 class PaillierPublicKey {
 public:
     PaillierPublicKey(const mpz_class& n);
     mpz_class encrypt(const mpz_class& message, const mpz_class& r = 0) const;
     mpz_class encrypt_raw(const mpz_class& message, const mpz_class& r) const;
+    // 批量加密：out 由调用者提供 count 个元素，在线程池中并行计算
+    void encrypt_batch(const mpz_class* messages, size_t count, mpz_class* out,
+                       ThreadPool& pool = ThreadPool::global()) const;
+    std::vector<mpz_class> encrypt_batch(const std::vector<mpz_class>& messages) const;
+    // g^m mod n^2，g = n + 1 时等于 1 + (m mod n) * n
+    mpz_class g_pow(const mpz_class& message) const;
     mpz_class get_n() const { return n; }
     mpz_class get_n_squared() const { return n_squared; }
     mpz_class get_g() const { return g; }
     int get_bit_length() const;
 
+    // 启用后台随机数池：encrypt 未指定 r 时直接从池中取 r^n mod n^2
+    void enable_random_pool(const RandomPoolConfig& config = RandomPoolConfig());
+    std::shared_ptr<PaillierRandomPool> get_random_pool() const { return random_pool; }
+
+    // 启用固定基短指数加密：随机因子改为 h^alpha，需在 enable_random_pool 之前调用才会被池使用
+    void enable_fixed_base(const FixedBaseConfig& config = FixedBaseConfig());
+    std::shared_ptr<const PaillierFixedBaseTable> get_fixed_base() const { return fixed_base; }
+
+    // 模 n^2 的 Montgomery 上下文，供 MontCiphertext 和密文连乘使用；n^2 超过定宽上限时为空
+    std::shared_ptr<const MontgomeryContext> get_montgomery() const { return montgomery; }
+    // 指数 n 的滑动窗口计划，批量加密的 r^n 复用
+    const FixedExponentPlan& get_n_plan() const { return *n_plan; }
+
 private:
+    friend class PaillierKeyStore;
+    PaillierPublicKey() = default;
+
     mpz_class n;
     mpz_class n_squared;
     mpz_class g;  // 通常 g = n + 1
+    std::shared_ptr<PaillierRandomPool> random_pool;  // 公钥的拷贝共享同一个池
+    std::shared_ptr<const PaillierFixedBaseTable> fixed_base;
+    std::shared_ptr<const MontgomeryContext> montgomery;
+    std::shared_ptr<const FixedExponentPlan> n_plan;
+};
+
+// 解密路径：CRT 为默认快速路径，Reference 保留原始的 c^lambda mod n^2 计算用于对比测试
+enum class DecryptMode {
+    CRT,
+    Reference
 };
 
 class PaillierPrivateKey {
 public:
     PaillierPrivateKey(const mpz_class& p, const mpz_class& q);
-    mpz_class decrypt(const mpz_class& ciphertext) const;
+    // 持有私钥一方的加密：r^n 分别在 p^2、q^2 下计算后用 CRT 合并
+    mpz_class encrypt(const mpz_class& message, const mpz_class& r = 0) const;
+    mpz_class decrypt(const mpz_class& ciphertext, DecryptMode mode = DecryptMode::CRT) const;
+    // 小明文解密：仅在 p^2 下解密并返回有符号结果，要求 |m| 远小于 p/2（如 SEP/SCP 的符号判断）
+    mpz_class decrypt_small(const mpz_class& ciphertext) const;
+    // 批量解密：out 由调用者提供 count 个元素，在线程池中并行计算
+    void decrypt_batch(const mpz_class* ciphertexts, size_t count, mpz_class* out,
+                       ThreadPool& pool = ThreadPool::global()) const;
+    std::vector<mpz_class> decrypt_batch(const std::vector<mpz_class>& ciphertexts) const;
+    void decrypt_small_batch(const mpz_class* ciphertexts, size_t count, mpz_class* out,
+                             ThreadPool& pool = ThreadPool::global()) const;
     PaillierPublicKey get_public_key() const { return PaillierPublicKey(p * q); }
     mpz_class get_p() const { return p; }
     mpz_class get_q() const { return q; }
 
 private:
+    friend class PaillierKeyStore;
+    PaillierPrivateKey() = default;
+
     mpz_class p;
     mpz_class q;
     mpz_class n;
     mpz_class n_squared;
     mpz_class lambda;
     mpz_class mu;
+
+    // CRT 解密预计算值
+    mpz_class p_squared;
+    mpz_class q_squared;
+    mpz_class p_minus_1;
+    mpz_class q_minus_1;
+    mpz_class hp;       // L_p(g^(p-1) mod p^2)^(-1) mod p
+    mpz_class hq;       // L_q(g^(q-1) mod q^2)^(-1) mod q
+    mpz_class q_inv_p;  // q^(-1) mod p
+
+    // CRT 加密预计算值
+    mpz_class n_mod_phi_p_squared;  // n mod p(p-1)
+    mpz_class n_mod_phi_q_squared;  // n mod q(q-1)
+    mpz_class q_squared_inv;        // (q^2)^(-1) mod p^2
+
+    // 批量 CRT 解密 c^(p-1)、c^(q-1) 的滑动窗口计划
+    std::shared_ptr<const FixedExponentPlan> p_minus_1_plan;
+    std::shared_ptr<const FixedExponentPlan> q_minus_1_plan;
     
     void compute_lambda();
     void compute_mu();
+    void compute_crt();
+    void compute_plans();
+    mpz_class decrypt_reference(const mpz_class& ciphertext) const;
+    mpz_class decrypt_crt(const mpz_class& ciphertext) const;
 };
 
 class PaillierKeyPair {
@@ -52,7 +159,21 @@ public:
     PaillierPublicKey get_public_key() const { return public_key; }
     PaillierPrivateKey get_private_key() const { return private_key; }
 
+    // 使用 PaillierKeyGen 的并行筛选搜索生成密钥
     static PaillierKeyPair generate(int bits);
+    // 串行的 generate_prime 搜索，保留作为对照
+    static PaillierKeyPair generate_serial(int bits);
+
+    // 在公钥上建立固定基表，保存时一并写入密钥文件
+    void enable_fixed_base(const FixedBaseConfig& config = FixedBaseConfig()) {
+        public_key.enable_fixed_base(config);
+    }
+
+    // 保存/加载二进制密钥文件（含全部预计算值），加载时不需要重新生成或计算
+    void save(const std::string& path) const;
+    static PaillierKeyPair load(const std::string& path);
+    // 文件存在且位长一致时加载，否则生成并保存（覆盖位长不同的旧文件）；文件损坏时 load 抛出的异常照常传出
+    static PaillierKeyPair load_or_generate(const std::string& path, int bits);
 
 private:
     PaillierPublicKey public_key;
@@ -75,6 +196,21 @@ namespace PaillierHomomorphic {
     mpz_class multiply_scalar(const PaillierPublicKey& public_key, 
                              const mpz_class& encrypted_a, 
                              const mpz_class& scalar);
+
+    // 多个密文求和：E(a_1) * ... * E(a_k)，在 Montgomery 域内连乘，只做一次修正
+    mpz_class sum(const PaillierPublicKey& public_key,
+                  const mpz_class* ciphertexts,
+                  size_t count);
+    mpz_class sum(const PaillierPublicKey& public_key,
+                  const std::vector<mpz_class>& ciphertexts);
+
+    // 线性组合：prod c_k^(s_k) = E(sum s_k * m_k)，用同时多指数一次计算
+    // 相同密文的标量先合并，±1 只做乘法，负标量统一在最后做一次求逆；
+    // 只有一项且标量较大时退回 mpz_powm
+    mpz_class linear_combination(const PaillierPublicKey& public_key,
+                                 const mpz_class* const* ciphertexts,
+                                 const mpz_class* scalars,
+                                 size_t count);
 }
 
 // 工具函数
@@ -0,0 +1,202 @@
+#include "PaillierKeyGen.h"
+#include "SecureRandom.h"
+#include <algorithm>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// 多线程共享的统计计数
+struct AtomicStats {
+    std::atomic<uint64_t> windows{0};
+    std::atomic<uint64_t> candidates{0};
+
+    void export_to(KeyGenStats* stats) const {
+        if (stats != nullptr) {
+            stats->windows += windows.load();
+            stats->candidates += candidates.load();
+        }
+    }
+};
+
+// 小素数及其积树：levels[0] 为小素数本身，levels[i+1][j] = levels[i][2j] * levels[i][2j+1]
+struct SmallPrimeTree {
+    std::vector<unsigned long> primes;
+    std::vector<std::vector<mpz_class>> levels;
+
+    explicit SmallPrimeTree(int count) {
+        // 埃氏筛取前 count 个奇素数（候选都是奇数，不需要 2）
+        size_t limit = 64;
+        while (primes.size() < static_cast<size_t>(count)) {
+            limit *= 2;
+            primes.clear();
+            std::vector<bool> composite(limit + 1, false);
+            for (size_t i = 3; i <= limit && primes.size() < static_cast<size_t>(count); i += 2) {
+                if (composite[i]) {
+                    continue;
+                }
+                primes.push_back(i);
+                for (size_t j = i * i; j <= limit; j += 2 * i) {
+                    composite[j] = true;
+                }
+            }
+        }
+
+        std::vector<mpz_class> level(primes.begin(), primes.end());
+        levels.push_back(level);
+        while (levels.back().size() > 1) {
+            const std::vector<mpz_class>& below = levels.back();
+            std::vector<mpz_class> above((below.size() + 1) / 2);
+            for (size_t i = 0; i < above.size(); i++) {
+                above[i] = (2 * i + 1 < below.size()) ? below[2 * i] * below[2 * i + 1] : below[2 * i];
+            }
+            levels.push_back(above);
+        }
+    }
+
+    // 余数树：自顶向下逐层取模，一次大数取模加上 O(log k) 层较小的取模得到 base 对所有小素数的余数
+    void remainders(const mpz_class& base, std::vector<unsigned long>& out) const {
+        std::vector<mpz_class> current(1);
+        mpz_mod(current[0].get_mpz_t(), base.get_mpz_t(), levels.back()[0].get_mpz_t());
+        for (size_t l = levels.size() - 1; l-- > 0;) {
+            const std::vector<mpz_class>& moduli = levels[l];
+            std::vector<mpz_class> next(moduli.size());
+            for (size_t i = 0; i < moduli.size(); i++) {
+                mpz_mod(next[i].get_mpz_t(), current[i / 2].get_mpz_t(), moduli[i].get_mpz_t());
+            }
+            current.swap(next);
+        }
+
+        out.resize(primes.size());
+        for (size_t i = 0; i < primes.size(); i++) {
+            out[i] = current[i].get_ui();
+        }
+    }
+};
+
+mpz_class search_prime_with(int bits, const KeyGenConfig& config, const SmallPrimeTree& tree,
+                            const std::atomic<bool>& cancel, AtomicStats& stats) {
+    size_t window = static_cast<size_t>(std::max(config.window, 1));
+    std::vector<unsigned long> residues;
+    std::vector<uint8_t> composite(window);
+
+    while (!cancel.load(std::memory_order_relaxed)) {
+        // 随机奇数基，最高两位置 1，保证 p*q 恰为 2*bits 位
+        mpz_class base = SecureRandom::random_bits(bits);
+        mpz_setbit(base.get_mpz_t(), bits - 1);
+        mpz_setbit(base.get_mpz_t(), bits - 2);
+        mpz_setbit(base.get_mpz_t(), 0);
+
+        // 窗口内候选为 base + 2k，若 base + 2k ≡ 0 (mod s) 则 k ≡ -base * 2^(-1) (mod s)
+        tree.remainders(base, residues);
+        std::fill(composite.begin(), composite.end(), 0);
+        for (size_t i = 0; i < tree.primes.size(); i++) {
+            unsigned long s = tree.primes[i];
+            unsigned long k = ((s - residues[i]) % s) * ((s + 1) / 2) % s;
+            for (; k < window; k += s) {
+                composite[k] = 1;
+            }
+        }
+        stats.windows++;
+
+        mpz_class candidate;
+        for (size_t k = 0; k < window; k++) {
+            if (composite[k]) {
+                continue;
+            }
+            if (cancel.load(std::memory_order_relaxed)) {
+                return 0;
+            }
+            candidate = base + 2 * k;
+            stats.candidates++;
+            if (mpz_probab_prime_p(candidate.get_mpz_t(), config.mr_rounds) != 0 &&
+                mpz_sizeinbase(candidate.get_mpz_t(), 2) == static_cast<size_t>(bits)) {
+                return candidate;
+            }
+        }
+    }
+    return 0;
+}
+
+}
+
+mpz_class PaillierKeyGen::search_prime(int bits, const KeyGenConfig& config, const std::atomic<bool>& cancel,
+                                       KeyGenStats* stats) {
+    if (bits < 64) {
+        // 位数太小时筛选用的小素数会覆盖候选本身，直接使用简单搜索
+        return PaillierUtil::generate_prime(bits);
+    }
+    SmallPrimeTree tree(config.sieve_primes);
+    AtomicStats counters;
+    mpz_class prime = search_prime_with(bits, config, tree, cancel, counters);
+    counters.export_to(stats);
+    return prime;
+}
+
+PaillierKeyPair PaillierKeyGen::generate(int bits, const KeyGenConfig& config, KeyGenStats* stats) {
+    int prime_size = bits / 2;
+    if (prime_size < 64) {
+        return PaillierKeyPair::generate_serial(bits);
+    }
+
+    int num_threads = config.num_threads;
+    if (num_threads <= 0) {
+        num_threads = std::max(2, static_cast<int>(std::thread::hardware_concurrency()));
+    }
+
+    SmallPrimeTree tree(config.sieve_primes);
+    AtomicStats counters;
+
+    while (true) {
+        std::mutex mutex;
+        mpz_class found[2];
+        std::atomic<bool> target_done[2];
+        target_done[0] = false;
+        target_done[1] = false;
+
+        // 线程 i 优先搜索 p 或 q（i 的奇偶），自己的目标已被找到后转去帮忙搜索另一个
+        auto worker = [&](int index) {
+            while (true) {
+                int target = index % 2;
+                if (target_done[target].load()) {
+                    target = 1 - target;
+                    if (target_done[target].load()) {
+                        return;
+                    }
+                }
+
+                mpz_class prime = search_prime_with(prime_size, config, tree, target_done[target], counters);
+                if (prime == 0) {
+                    continue;
+                }
+
+                std::lock_guard<std::mutex> lock(mutex);
+                if (!target_done[target].load()) {
+                    found[target] = prime;
+                    target_done[target] = true;
+                }
+            }
+        };
+
+        std::vector<std::thread> threads;
+        for (int i = 0; i < num_threads; i++) {
+            threads.emplace_back(worker, i);
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+
+        const mpz_class& p = found[0];
+        const mpz_class& q = found[1];
+        if (p != q && PaillierUtil::is_coprime((p - 1) * (q - 1), p * q)) {
+            counters.export_to(stats);
+            PaillierPrivateKey private_key(p, q);
+            PaillierPublicKey public_key = private_key.get_public_key();
+            return PaillierKeyPair(public_key, private_key);
+        }
+        if (stats != nullptr) {
+            stats->restarts++;
+        }
+    }
+}
@@ -0,0 +1,35 @@
+#ifndef PAILLIER_KEYGEN_H
+#define PAILLIER_KEYGEN_H
+
+#include "PaillierCrypto.h"
+#include <atomic>
+#include <cstdint>
+
+// 素数搜索配置
+struct KeyGenConfig {
+    int num_threads = 0;        // 搜索线程数，<= 0 表示 max(2, hardware_concurrency)
+    int sieve_primes = 2048;    // 用于筛选的小素数个数
+    int window = 4096;          // 每个筛选窗口内的候选个数（奇数步长）
+    int mr_rounds = 30;         // mpz_probab_prime_p 的轮数
+};
+
+// 搜索过程统计
+struct KeyGenStats {
+    uint64_t windows = 0;       // 筛选过的窗口数
+    uint64_t candidates = 0;    // 通过筛选、进入素性测试的候选数
+    uint64_t restarts = 0;      // p、q 不满足条件而重新搜索的次数
+};
+
+// 并行筛选素数搜索：p 与 q 在不同线程上同时搜索
+// 每个窗口先用积树批量求出基数对各小素数的余数，再在窗口内筛掉小素因子，
+// 幸存的候选才做 Miller-Rabin；两个素数都找到后其余线程协作退出
+namespace PaillierKeyGen {
+    // 搜索一个恰为 bits 位（最高两位为 1）的素数，cancel 置位时返回 0
+    mpz_class search_prime(int bits, const KeyGenConfig& config, const std::atomic<bool>& cancel,
+                           KeyGenStats* stats = nullptr);
+
+    PaillierKeyPair generate(int bits, const KeyGenConfig& config = KeyGenConfig(),
+                             KeyGenStats* stats = nullptr);
+}
+
+#endif // PAILLIER_KEYGEN_H
@@ -0,0 +1,312 @@
+#include "PaillierKeyStore.h"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+
+const char KEY_FILE_MAGIC[8] = {'P', 'S', 'I', 'P', 'A', 'I', 'L', 'K'};
+const uint32_t KEY_FILE_VERSION = 1;
+const uint32_t ENDIAN_MARK = 0x01020304;
+
+struct KeyFileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t field_count;
+    uint32_t limb_bytes;
+    uint32_t endian_mark;
+    uint64_t reserved;
+};
+
+struct FieldHeader {
+    uint32_t id;
+    uint32_t reserved;
+    uint64_t limbs;
+};
+
+static_assert(sizeof(KeyFileHeader) == 32, "key file header must be 32 bytes");
+static_assert(sizeof(FieldHeader) == 16, "field header must be 16 bytes");
+
+enum FieldId : uint32_t {
+    FIELD_N = 1,
+    FIELD_N_SQUARED,
+    FIELD_P,
+    FIELD_Q,
+    FIELD_LAMBDA,
+    FIELD_MU,
+    FIELD_P_SQUARED,
+    FIELD_Q_SQUARED,
+    FIELD_HP,
+    FIELD_HQ,
+    FIELD_Q_INV_P,
+    FIELD_N_MOD_PHI_P_SQUARED,
+    FIELD_N_MOD_PHI_Q_SQUARED,
+    FIELD_Q_SQUARED_INV,
+    // 固定基表：参数 [window_bits, exponent_bits]、h，之后按顺序是所有表项
+    FIELD_FIXED_BASE_PARAMS = 32,
+    FIELD_FIXED_BASE_H,
+    FIELD_FIXED_BASE_ENTRY
+};
+
+class KeyFileWriter {
+public:
+    void add(uint32_t id, const mp_limb_t* limbs, size_t count) {
+        FieldHeader header = {id, 0, count};
+        append(&header, sizeof(header));
+        append(limbs, count * sizeof(mp_limb_t));
+        field_count++;
+    }
+
+    void add(uint32_t id, const mpz_class& value) {
+        if (value < 0) {
+            throw std::runtime_error("Key store only holds non-negative integers");
+        }
+        add(id, mpz_limbs_read(value.get_mpz_t()), mpz_size(value.get_mpz_t()));
+    }
+
+    void write(const std::string& path) const {
+        KeyFileHeader header;
+        std::memcpy(header.magic, KEY_FILE_MAGIC, sizeof(header.magic));
+        header.version = KEY_FILE_VERSION;
+        header.field_count = field_count;
+        header.limb_bytes = sizeof(mp_limb_t);
+        header.endian_mark = ENDIAN_MARK;
+        header.reserved = 0;
+
+        // 先写临时文件再改名，私钥文件权限为 0600
+        std::string tmp_path = path + ".tmp";
+        int fd = ::open(tmp_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0600);
+        if (fd < 0) {
+            throw std::runtime_error("Cannot create key file: " + tmp_path);
+        }
+        bool ok = write_all(fd, &header, sizeof(header)) && write_all(fd, body.data(), body.size()) &&
+                  ::fsync(fd) == 0;
+        ::close(fd);
+        if (!ok || ::rename(tmp_path.c_str(), path.c_str()) != 0) {
+            ::unlink(tmp_path.c_str());
+            throw std::runtime_error("Failed to write key file: " + path);
+        }
+    }
+
+private:
+    std::vector<unsigned char> body;
+    uint32_t field_count = 0;
+
+    void append(const void* data, size_t len) {
+        const unsigned char* bytes = static_cast<const unsigned char*>(data);
+        body.insert(body.end(), bytes, bytes + len);
+    }
+
+    static bool write_all(int fd, const void* data, size_t len) {
+        const unsigned char* bytes = static_cast<const unsigned char*>(data);
+        while (len > 0) {
+            ssize_t written = ::write(fd, bytes, len);
+            if (written <= 0) {
+                return false;
+            }
+            bytes += written;
+            len -= static_cast<size_t>(written);
+        }
+        return true;
+    }
+};
+
+// 只读映射整个密钥文件，析构时解除映射
+class MappedKeyFile {
+public:
+    explicit MappedKeyFile(const std::string& path) {
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            throw std::runtime_error("Cannot open key file: " + path);
+        }
+        struct stat st;
+        if (::fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(sizeof(KeyFileHeader))) {
+            ::close(fd);
+            throw std::runtime_error("Key file is truncated: " + path);
+        }
+        size = static_cast<size_t>(st.st_size);
+        data = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (data == MAP_FAILED) {
+            throw std::runtime_error("Cannot mmap key file: " + path);
+        }
+    }
+
+    ~MappedKeyFile() {
+        ::munmap(data, size);
+    }
+
+    MappedKeyFile(const MappedKeyFile&) = delete;
+    MappedKeyFile& operator=(const MappedKeyFile&) = delete;
+
+    const unsigned char* bytes() const { return static_cast<const unsigned char*>(data); }
+    size_t length() const { return size; }
+
+private:
+    void* data;
+    size_t size;
+};
+
+struct FieldView {
+    const mp_limb_t* limbs;
+    size_t count;
+};
+
+void import_limbs(mpz_class& out, const FieldView& field) {
+    if (field.count == 0) {
+        out = 0;
+        return;
+    }
+    mp_limb_t* dst = mpz_limbs_write(out.get_mpz_t(), field.count);
+    std::memcpy(dst, field.limbs, field.count * sizeof(mp_limb_t));
+    mpz_limbs_finish(out.get_mpz_t(), field.count);
+}
+
+}
+
+void PaillierKeyStore::save(const std::string& path, const PaillierKeyPair& key_pair) {
+    PaillierPrivateKey sk = key_pair.get_private_key();
+    PaillierPublicKey pk = key_pair.get_public_key();
+
+    KeyFileWriter writer;
+    writer.add(FIELD_N, sk.n);
+    writer.add(FIELD_N_SQUARED, sk.n_squared);
+    writer.add(FIELD_P, sk.p);
+    writer.add(FIELD_Q, sk.q);
+    writer.add(FIELD_LAMBDA, sk.lambda);
+    writer.add(FIELD_MU, sk.mu);
+    writer.add(FIELD_P_SQUARED, sk.p_squared);
+    writer.add(FIELD_Q_SQUARED, sk.q_squared);
+    writer.add(FIELD_HP, sk.hp);
+    writer.add(FIELD_HQ, sk.hq);
+    writer.add(FIELD_Q_INV_P, sk.q_inv_p);
+    writer.add(FIELD_N_MOD_PHI_P_SQUARED, sk.n_mod_phi_p_squared);
+    writer.add(FIELD_N_MOD_PHI_Q_SQUARED, sk.n_mod_phi_q_squared);
+    writer.add(FIELD_Q_SQUARED_INV, sk.q_squared_inv);
+
+    if (pk.fixed_base) {
+        const PaillierFixedBaseTable& table = *pk.fixed_base;
+        mp_limb_t params[2] = {static_cast<mp_limb_t>(table.window_bits),
+                               static_cast<mp_limb_t>(table.exponent_bits)};
+        writer.add(FIELD_FIXED_BASE_PARAMS, params, 2);
+        writer.add(FIELD_FIXED_BASE_H, table.h);
+        for (const auto& entry : table.table) {
+            writer.add(FIELD_FIXED_BASE_ENTRY, entry);
+        }
+    }
+
+    writer.write(path);
+}
+
+PaillierKeyPair PaillierKeyStore::load(const std::string& path) {
+    MappedKeyFile file(path);
+    const unsigned char* bytes = file.bytes();
+
+    KeyFileHeader header;
+    std::memcpy(&header, bytes, sizeof(header));
+    if (std::memcmp(header.magic, KEY_FILE_MAGIC, sizeof(header.magic)) != 0) {
+        throw std::runtime_error("Not a Paillier key file: " + path);
+    }
+    if (header.version != KEY_FILE_VERSION || header.limb_bytes != sizeof(mp_limb_t) ||
+        header.endian_mark != ENDIAN_MARK) {
+        throw std::runtime_error("Unsupported key file version or platform: " + path);
+    }
+
+    // 扫描字段记录，limb 数据直接指向映射内存
+    std::map<uint32_t, FieldView> fields;
+    std::vector<FieldView> fixed_base_entries;
+    size_t offset = sizeof(KeyFileHeader);
+    for (uint32_t i = 0; i < header.field_count; i++) {
+        if (offset + sizeof(FieldHeader) > file.length()) {
+            throw std::runtime_error("Key file is truncated: " + path);
+        }
+        FieldHeader field;
+        std::memcpy(&field, bytes + offset, sizeof(field));
+        offset += sizeof(field);
+        if (field.limbs > (file.length() - offset) / sizeof(mp_limb_t)) {
+            throw std::runtime_error("Key file is truncated: " + path);
+        }
+        FieldView view = {reinterpret_cast<const mp_limb_t*>(bytes + offset), static_cast<size_t>(field.limbs)};
+        offset += field.limbs * sizeof(mp_limb_t);
+
+        if (field.id == FIELD_FIXED_BASE_ENTRY) {
+            fixed_base_entries.push_back(view);
+        } else {
+            fields[field.id] = view;
+        }
+    }
+
+    auto require = [&](uint32_t id) -> const FieldView& {
+        auto it = fields.find(id);
+        if (it == fields.end()) {
+            throw std::runtime_error("Key file is missing a required field: " + path);
+        }
+        return it->second;
+    };
+
+    PaillierPrivateKey sk;
+    import_limbs(sk.n, require(FIELD_N));
+    import_limbs(sk.n_squared, require(FIELD_N_SQUARED));
+    import_limbs(sk.p, require(FIELD_P));
+    import_limbs(sk.q, require(FIELD_Q));
+    import_limbs(sk.lambda, require(FIELD_LAMBDA));
+    import_limbs(sk.mu, require(FIELD_MU));
+    import_limbs(sk.p_squared, require(FIELD_P_SQUARED));
+    import_limbs(sk.q_squared, require(FIELD_Q_SQUARED));
+    import_limbs(sk.hp, require(FIELD_HP));
+    import_limbs(sk.hq, require(FIELD_HQ));
+    import_limbs(sk.q_inv_p, require(FIELD_Q_INV_P));
+    import_limbs(sk.n_mod_phi_p_squared, require(FIELD_N_MOD_PHI_P_SQUARED));
+    import_limbs(sk.n_mod_phi_q_squared, require(FIELD_N_MOD_PHI_Q_SQUARED));
+    import_limbs(sk.q_squared_inv, require(FIELD_Q_SQUARED_INV));
+    sk.p_minus_1 = sk.p - 1;
+    sk.q_minus_1 = sk.q - 1;
+    sk.compute_plans();
+
+    if (sk.p * sk.q != sk.n) {
+        throw std::runtime_error("Key file is corrupted (n != p * q): " + path);
+    }
+
+    PaillierPublicKey pk;
+    pk.n = sk.n;
+    pk.n_squared = sk.n_squared;
+    pk.g = sk.n + 1;
+    if (mpz_size(pk.n_squared.get_mpz_t()) <= MontgomeryContext::MAX_LIMBS) {
+        pk.montgomery = std::make_shared<MontgomeryContext>(pk.n_squared);
+    }
+    pk.n_plan = std::make_shared<FixedExponentPlan>(pk.n);
+
+    auto params = fields.find(FIELD_FIXED_BASE_PARAMS);
+    if (params != fields.end()) {
+        if (params->second.count != 2) {
+            throw std::runtime_error("Key file has malformed fixed-base parameters: " + path);
+        }
+        auto table = std::shared_ptr<PaillierFixedBaseTable>(new PaillierFixedBaseTable());
+        table->window_bits = static_cast<int>(params->second.limbs[0]);
+        table->exponent_bits = static_cast<int>(params->second.limbs[1]);
+        if (table->window_bits < 1 || table->window_bits > 16 || table->exponent_bits <= 0) {
+            throw std::runtime_error("Key file has malformed fixed-base parameters: " + path);
+        }
+        table->num_windows = (table->exponent_bits + table->window_bits - 1) / table->window_bits;
+        table->n_squared = sk.n_squared;
+        import_limbs(table->h, require(FIELD_FIXED_BASE_H));
+
+        size_t expected = static_cast<size_t>(table->num_windows) << table->window_bits;
+        if (fixed_base_entries.size() != expected) {
+            throw std::runtime_error("Key file has an incomplete fixed-base table: " + path);
+        }
+        table->table.resize(expected);
+        for (size_t i = 0; i < expected; i++) {
+            import_limbs(table->table[i], fixed_base_entries[i]);
+        }
+        pk.fixed_base = table;
+    }
+
+    return PaillierKeyPair(pk, sk);
+}
@@ -0,0 +1,17 @@
+#ifndef PAILLIER_KEY_STORE_H
+#define PAILLIER_KEY_STORE_H
+
+#include "PaillierCrypto.h"
+#include <string>
+
+// Paillier 密钥文件（二进制，本机字节序）：
+//   头部 32 字节：magic "PSIPAILK"、版本、字段数、limb 字节数、字节序标记
+//   之后是字段记录：u32 字段 id、u32 保留、u64 limb 个数，随后是 limb 数组（8 字节对齐）
+// 保存 n、p、q 以及 n^2、lambda、mu、CRT 常量和可选的固定基表，加载时通过 mmap 直接导入，不做任何模幂或求逆
+class PaillierKeyStore {
+public:
+    static void save(const std::string& path, const PaillierKeyPair& key_pair);
+    static PaillierKeyPair load(const std::string& path);
+};
+
+#endif // PAILLIER_KEY_STORE_H
@@ -0,0 +1,359 @@
+#include "PaillierMontgomery.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+
+// MontgomeryContext implementation
+MontgomeryContext::MontgomeryContext(const mpz_class& modulus) : modulus(modulus) {
+    if (modulus <= 1 || mpz_even_p(modulus.get_mpz_t())) {
+        throw std::runtime_error("Montgomery modulus must be odd and greater than 1");
+    }
+    k = mpz_size(modulus.get_mpz_t());
+    if (k > MAX_LIMBS) {
+        throw std::runtime_error("Modulus is too large for the fixed-width ciphertext");
+    }
+    const mp_limb_t* src = mpz_limbs_read(modulus.get_mpz_t());
+    n.assign(src, src + k);
+
+    // 牛顿迭代求 N^(-1) mod 2^GMP_NUMB_BITS：初值对奇数 N 已正确到 3 位，每次迭代精度翻倍
+    mp_limb_t inv = n[0];
+    for (int bits = 3; bits < GMP_NUMB_BITS; bits *= 2) {
+        inv *= 2 - n[0] * inv;
+    }
+    n0_inv = -inv;
+
+    mpz_class r;
+    mpz_setbit(r.get_mpz_t(), GMP_NUMB_BITS * k);
+    mpz_class r1 = r % modulus;
+    mpz_class r2 = (r1 * r1) % modulus;
+    r_mod_n.resize(k);
+    r2_mod_n.resize(k);
+    load(r_mod_n.data(), r1);
+    load(r2_mod_n.data(), r2);
+}
+
+void MontgomeryContext::load(mp_limb_t* out, const mpz_class& value) const {
+    const mpz_class* source = &value;
+    mpz_class reduced;
+    if (value < 0 || value >= modulus) {
+        mpz_mod(reduced.get_mpz_t(), value.get_mpz_t(), modulus.get_mpz_t());
+        source = &reduced;
+    }
+    size_t size = mpz_size(source->get_mpz_t());
+    if (size > 0) {
+        std::memcpy(out, mpz_limbs_read(source->get_mpz_t()), size * sizeof(mp_limb_t));
+    }
+    std::memset(out + size, 0, (k - size) * sizeof(mp_limb_t));
+}
+
+void MontgomeryContext::redc(mp_limb_t* out, mp_limb_t* t) const {
+    // 每轮消去最低 limb，进位暂存在被消去的位置，最后一次性加回高半部分
+    mp_limb_t* up = t;
+    for (size_t i = 0; i < k; i++) {
+        mp_limb_t q = up[0] * n0_inv;
+        up[0] = mpn_addmul_1(up, n.data(), k, q);
+        up++;
+    }
+    mp_limb_t carry = mpn_add_n(out, up, t, k);
+    // 输入小于 N 时结果小于 2N，至多减一次
+    if (carry != 0 || mpn_cmp(out, n.data(), k) >= 0) {
+        mpn_sub_n(out, out, n.data(), k);
+    }
+}
+
+void MontgomeryContext::mul(mp_limb_t* out, const mp_limb_t* a, const mp_limb_t* b) const {
+    mp_limb_t t[2 * MAX_LIMBS];
+    if (a == b) {
+        mpn_sqr(t, a, k);
+    } else {
+        mpn_mul_n(t, a, b, k);
+    }
+    redc(out, t);
+}
+
+void MontgomeryContext::sqr(mp_limb_t* out, const mp_limb_t* a) const {
+    mp_limb_t t[2 * MAX_LIMBS];
+    mpn_sqr(t, a, k);
+    redc(out, t);
+}
+
+void MontgomeryContext::pow(mp_limb_t* out, const mp_limb_t* base, const mpz_class& exponent) const {
+    if (exponent < 0) {
+        throw std::runtime_error("Montgomery pow requires a non-negative exponent");
+    }
+    size_t bits = mpz_sizeinbase(exponent.get_mpz_t(), 2);
+    if (exponent == 0) {
+        std::memcpy(out, r_mod_n.data(), k * sizeof(mp_limb_t));
+        return;
+    }
+
+    // 4 位固定窗口：table[d] = base^d
+    const int WINDOW = 4;
+    mp_limb_t table[1 << WINDOW][MAX_LIMBS];
+    std::memcpy(table[0], r_mod_n.data(), k * sizeof(mp_limb_t));
+    std::memcpy(table[1], base, k * sizeof(mp_limb_t));
+    for (int d = 2; d < (1 << WINDOW); d++) {
+        mul(table[d], table[d - 1], base);
+    }
+
+    mp_limb_t acc[MAX_LIMBS];
+    std::memcpy(acc, r_mod_n.data(), k * sizeof(mp_limb_t));
+    size_t windows = (bits + WINDOW - 1) / WINDOW;
+    for (size_t w = windows; w-- > 0;) {
+        if (w + 1 != windows) {
+            for (int s = 0; s < WINDOW; s++) {
+                sqr(acc, acc);
+            }
+        }
+        unsigned digit = 0;
+        for (int s = WINDOW - 1; s >= 0; s--) {
+            digit = (digit << 1) | mpz_tstbit(exponent.get_mpz_t(), w * WINDOW + s);
+        }
+        if (digit != 0) {
+            mul(acc, acc, table[digit]);
+        }
+    }
+    std::memcpy(out, acc, k * sizeof(mp_limb_t));
+}
+
+// FixedExponentPlan implementation
+FixedExponentPlan::FixedExponentPlan(const mpz_class& exponent) : exponent(exponent) {
+    if (exponent < 0) {
+        throw std::runtime_error("Fixed exponent plan requires a non-negative exponent");
+    }
+    // 平方次数与窗口无关，只比较模乘：奇数幂表 2^(w-1) 次 + 窗口个数
+    size_t best = SIZE_MAX;
+    for (int w = 1; w <= MAX_WINDOW; w++) {
+        std::vector<Step> candidate;
+        uint32_t trailing;
+        recode(exponent, w, candidate, trailing);
+        size_t cost = (w > 1 ? (size_t(1) << (w - 1)) : 0) + candidate.size();
+        if (cost < best) {
+            best = cost;
+            window_bits = w;
+            steps = std::move(candidate);
+            trailing_squarings = trailing;
+        }
+    }
+}
+
+void FixedExponentPlan::recode(const mpz_class& exponent, int window_bits, std::vector<Step>& steps,
+                               uint32_t& trailing_squarings) {
+    // 从高位向低位扫描：遇 0 只平方，遇 1 取至多 w 位且以 1 结尾的窗口
+    mpz_srcptr e = exponent.get_mpz_t();
+    uint32_t pending = 0;
+    long i = exponent == 0 ? -1 : static_cast<long>(mpz_sizeinbase(e, 2)) - 1;
+    while (i >= 0) {
+        if (!mpz_tstbit(e, i)) {
+            pending++;
+            i--;
+            continue;
+        }
+        long j = std::max(i - window_bits + 1, 0L);
+        while (!mpz_tstbit(e, j)) {
+            j++;
+        }
+        uint32_t digit = 0;
+        for (long b = i; b >= j; b--) {
+            digit = (digit << 1) | mpz_tstbit(e, b);
+        }
+        steps.push_back(Step{pending + static_cast<uint32_t>(i - j + 1), digit});
+        pending = 0;
+        i = j - 1;
+    }
+    trailing_squarings = pending;
+}
+
+void FixedExponentPlan::pow(const MontgomeryContext& ctx, mp_limb_t* out, const mp_limb_t* base) const {
+    size_t k = ctx.size();
+    if (steps.empty()) {
+        std::memcpy(out, ctx.one(), k * sizeof(mp_limb_t));
+        return;
+    }
+
+    // table[i] = base^(2i+1)
+    mp_limb_t table[1 << (MAX_WINDOW - 1)][MontgomeryContext::MAX_LIMBS];
+    size_t entries = size_t(1) << (window_bits - 1);
+    std::memcpy(table[0], base, k * sizeof(mp_limb_t));
+    if (entries > 1) {
+        mp_limb_t base_squared[MontgomeryContext::MAX_LIMBS];
+        ctx.sqr(base_squared, base);
+        for (size_t d = 1; d < entries; d++) {
+            ctx.mul(table[d], table[d - 1], base_squared);
+        }
+    }
+
+    mp_limb_t acc[MontgomeryContext::MAX_LIMBS];
+    std::memcpy(acc, table[steps[0].digit >> 1], k * sizeof(mp_limb_t));
+    for (size_t s = 1; s < steps.size(); s++) {
+        for (uint32_t t = 0; t < steps[s].squarings; t++) {
+            ctx.sqr(acc, acc);
+        }
+        ctx.mul(acc, acc, table[steps[s].digit >> 1]);
+    }
+    for (uint32_t t = 0; t < trailing_squarings; t++) {
+        ctx.sqr(acc, acc);
+    }
+    std::memcpy(out, acc, k * sizeof(mp_limb_t));
+}
+
+mpz_class FixedExponentPlan::pow(const MontgomeryContext& ctx, const mpz_class& base) const {
+    mp_limb_t value[MontgomeryContext::MAX_LIMBS];
+    ctx.to_montgomery(value, base);
+    pow(ctx, value, value);
+    return ctx.from_montgomery(value);
+}
+
+size_t FixedExponentPlan::multiplications() const {
+    if (steps.empty()) {
+        return 0;
+    }
+    size_t table = window_bits > 1 ? (size_t(1) << (window_bits - 1)) : 0;
+    return table + steps.size() - 1;
+}
+
+size_t FixedExponentPlan::squarings() const {
+    if (steps.empty()) {
+        return 0;
+    }
+    size_t total = trailing_squarings;
+    for (size_t s = 1; s < steps.size(); s++) {
+        total += steps[s].squarings;
+    }
+    return total;
+}
+
+void MontgomeryContext::to_montgomery(mp_limb_t* out, const mpz_class& value) const {
+    mp_limb_t plain[MAX_LIMBS];
+    load(plain, value);
+    mul(out, plain, r2_mod_n.data());
+}
+
+mpz_class MontgomeryContext::from_montgomery(const mp_limb_t* value) const {
+    mp_limb_t t[2 * MAX_LIMBS];
+    std::memcpy(t, value, k * sizeof(mp_limb_t));
+    std::memset(t + k, 0, k * sizeof(mp_limb_t));
+    mpz_class result;
+    mp_limb_t* dst = mpz_limbs_write(result.get_mpz_t(), k);
+    redc(dst, t);
+    mpz_limbs_finish(result.get_mpz_t(), k);
+    return result;
+}
+
+const std::vector<mp_limb_t>& MontgomeryContext::correction(size_t count) const {
+    std::lock_guard<std::mutex> lock(correction_mutex);
+    auto it = corrections.find(count);
+    if (it != corrections.end()) {
+        return it->second;
+    }
+    mpz_class r1 = from_montgomery(r2_mod_n.data());  // R mod N
+    mpz_class value;
+    mpz_powm_ui(value.get_mpz_t(), r1.get_mpz_t(), count, modulus.get_mpz_t());
+    std::vector<mp_limb_t> limbs(k);
+    load(limbs.data(), value);
+    return corrections.emplace(count, std::move(limbs)).first->second;
+}
+
+mpz_class MontgomeryContext::product(const mpz_class* values, size_t count) const {
+    if (count == 0) {
+        return 1;
+    }
+    if (count == 1) {
+        mpz_class result;
+        mpz_mod(result.get_mpz_t(), values[0].get_mpz_t(), modulus.get_mpz_t());
+        return result;
+    }
+
+    // 普通形式直接做 Montgomery 乘法，每次多出一个 R^(-1)，
+    // count - 1 次之后乘以 R^count 再做一次 REDC 即可抵消
+    mp_limb_t acc[MAX_LIMBS];
+    mp_limb_t operand[MAX_LIMBS];
+    load(acc, values[0]);
+    for (size_t i = 1; i < count; i++) {
+        load(operand, values[i]);
+        mul(acc, acc, operand);
+    }
+    mul(acc, acc, correction(count).data());
+
+    mpz_class result;
+    mp_limb_t* dst = mpz_limbs_write(result.get_mpz_t(), k);
+    std::memcpy(dst, acc, k * sizeof(mp_limb_t));
+    mpz_limbs_finish(result.get_mpz_t(), k);
+    return result;
+}
+
+// BasicMontCiphertext implementation
+template <size_t Limbs>
+const MontgomeryContext& BasicMontCiphertext<Limbs>::check_width(const MontgomeryContext& ctx) {
+    if (ctx.size() > Limbs) {
+        throw std::runtime_error("Modulus is too large for this ciphertext width");
+    }
+    return ctx;
+}
+
+template <size_t Limbs>
+BasicMontCiphertext<Limbs>::BasicMontCiphertext(const MontgomeryContext& ctx) : ctx(&check_width(ctx)) {
+    std::memcpy(limbs.data(), ctx.one(), ctx.size() * sizeof(mp_limb_t));
+}
+
+template <size_t Limbs>
+BasicMontCiphertext<Limbs>::BasicMontCiphertext(const MontgomeryContext& ctx, const mpz_class& ciphertext)
+    : ctx(&check_width(ctx)) {
+    ctx.to_montgomery(limbs.data(), ciphertext);
+}
+
+template <size_t Limbs>
+BasicMontCiphertext<Limbs>& BasicMontCiphertext<Limbs>::operator+=(const BasicMontCiphertext& other) {
+    if (ctx != other.ctx) {
+        throw std::runtime_error("Cannot add ciphertexts with different public keys");
+    }
+    ctx->mul(limbs.data(), limbs.data(), other.limbs.data());
+    return *this;
+}
+
+template <size_t Limbs>
+BasicMontCiphertext<Limbs> BasicMontCiphertext<Limbs>::operator+(const BasicMontCiphertext& other) const {
+    BasicMontCiphertext result = *this;
+    result += other;
+    return result;
+}
+
+template <size_t Limbs>
+BasicMontCiphertext<Limbs>& BasicMontCiphertext<Limbs>::operator*=(const mpz_class& scalar) {
+    if (scalar < 0) {
+        // 求逆需要离开 Montgomery 形式，只在负数标量时发生
+        mpz_class inverse = to_mpz();
+        if (mpz_invert(inverse.get_mpz_t(), inverse.get_mpz_t(), ctx->get_modulus().get_mpz_t()) == 0) {
+            throw std::runtime_error("Ciphertext is not invertible");
+        }
+        ctx->to_montgomery(limbs.data(), inverse);
+        mpz_class magnitude = -scalar;
+        ctx->pow(limbs.data(), limbs.data(), magnitude);
+    } else {
+        ctx->pow(limbs.data(), limbs.data(), scalar);
+    }
+    return *this;
+}
+
+template <size_t Limbs>
+BasicMontCiphertext<Limbs> BasicMontCiphertext<Limbs>::operator*(const mpz_class& scalar) const {
+    BasicMontCiphertext result = *this;
+    result *= scalar;
+    return result;
+}
+
+template <size_t Limbs>
+BasicMontCiphertext<Limbs> BasicMontCiphertext<Limbs>::operator-() const {
+    return *this * mpz_class(-1);
+}
+
+template <size_t Limbs>
+mpz_class BasicMontCiphertext<Limbs>::to_mpz() const {
+    return ctx->from_montgomery(limbs.data());
+}
+
+template class BasicMontCiphertext<2048 / GMP_NUMB_BITS>;
+template class BasicMontCiphertext<4096 / GMP_NUMB_BITS>;
+template class BasicMontCiphertext<6144 / GMP_NUMB_BITS>;
+template class BasicMontCiphertext<MontgomeryContext::MAX_LIMBS>;
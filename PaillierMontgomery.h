@@ -0,0 +1,136 @@
+#ifndef PAILLIER_MONTGOMERY_H
+#define PAILLIER_MONTGOMERY_H
+
+#include <gmpxx.h>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <vector>
+
+// REDC 按整 limb 消去低位，要求 limb 没有 nail 位
+static_assert(GMP_NAIL_BITS == 0, "Montgomery arithmetic requires GMP limbs without nail bits");
+
+// 模 n^2 的 Montgomery 运算上下文，R = 2^(GMP_NUMB_BITS * k)，k 为 n^2 的 limb 数
+// 乘法为 mpn_mul_n + 逐 limb 的 REDC，不做除法也不分配内存
+class MontgomeryContext {
+public:
+    // 内联 limb 上限：n^2 最多 8192 位（4096 位密钥）
+    static const size_t MAX_LIMBS = 8192 / GMP_NUMB_BITS;
+
+    explicit MontgomeryContext(const mpz_class& modulus);
+
+    size_t size() const { return k; }
+    const mpz_class& get_modulus() const { return modulus; }
+
+    // out = a * b * R^(-1) mod N，允许 out 与 a 或 b 相同
+    void mul(mp_limb_t* out, const mp_limb_t* a, const mp_limb_t* b) const;
+    void sqr(mp_limb_t* out, const mp_limb_t* a) const;
+    // out = base^exponent（均为 Montgomery 形式），exponent >= 0
+    void pow(mp_limb_t* out, const mp_limb_t* base, const mpz_class& exponent) const;
+
+    // 普通形式与 Montgomery 形式之间的转换
+    void to_montgomery(mp_limb_t* out, const mpz_class& value) const;
+    mpz_class from_montgomery(const mp_limb_t* value) const;
+    const mp_limb_t* one() const { return r_mod_n.data(); }
+
+    // 普通形式的连乘 prod(values) mod N：count - 1 次 Montgomery 乘法外加一次 R^count 修正，
+    // 输入无需先转换到 Montgomery 形式
+    mpz_class product(const mpz_class* values, size_t count) const;
+
+private:
+    mpz_class modulus;
+    size_t k;
+    std::vector<mp_limb_t> n;        // N 的 k 个 limb
+    mp_limb_t n0_inv;                // -N^(-1) mod 2^GMP_NUMB_BITS
+    std::vector<mp_limb_t> r_mod_n;  // R mod N（Montgomery 形式的 1）
+    std::vector<mp_limb_t> r2_mod_n; // R^2 mod N
+
+    mutable std::mutex correction_mutex;
+    mutable std::map<size_t, std::vector<mp_limb_t>> corrections;  // count -> R^count mod N
+
+    void redc(mp_limb_t* out, mp_limb_t* t) const;
+    void load(mp_limb_t* out, const mpz_class& value) const;
+    const std::vector<mp_limb_t>& correction(size_t count) const;
+};
+
+// 固定指数的滑动窗口计划：加密的 n、CRT 解密的 p-1/q-1、参考解密的 lambda 对同一密钥不变，
+// 构造时按指数选出总乘法次数最少的窗口宽度并完成重编码，之后每次求幂只按步骤做平方和乘法
+class FixedExponentPlan {
+public:
+    static const int MAX_WINDOW = 7;
+
+    // exponent >= 0
+    explicit FixedExponentPlan(const mpz_class& exponent);
+
+    // out = base^exponent（均为 Montgomery 形式），允许 out 与 base 相同
+    void pow(const MontgomeryContext& ctx, mp_limb_t* out, const mp_limb_t* base) const;
+    // 普通形式：base^exponent mod N
+    mpz_class pow(const MontgomeryContext& ctx, const mpz_class& base) const;
+
+    const mpz_class& get_exponent() const { return exponent; }
+    int get_window_bits() const { return window_bits; }
+    // 每次求幂的模乘次数（含奇数幂表）与平方次数
+    size_t multiplications() const;
+    size_t squarings() const;
+
+    // 先平方 squarings 次，再乘以 base^digit（digit 为奇数）
+    struct Step {
+        uint32_t squarings;
+        uint32_t digit;
+    };
+    // 供其他模乘实现（如多缓冲模幂）按同一计划执行
+    const std::vector<Step>& get_steps() const { return steps; }
+    uint32_t get_trailing_squarings() const { return trailing_squarings; }
+
+private:
+    mpz_class exponent;
+    int window_bits;
+    std::vector<Step> steps;  // 第一步的平方作用在 1 上，执行时跳过
+    uint32_t trailing_squarings;
+
+    static void recode(const mpz_class& exponent, int window_bits, std::vector<Step>& steps,
+                       uint32_t& trailing_squarings);
+};
+
+// 定宽 Paillier 密文：limb 内联存放并保持 Montgomery 形式，
+// 同态加法和标量乘法链中不再做除法取模，也不分配堆内存，只在序列化或解密前转换回 mpz_class。
+// Limbs 为内联容量，按密钥大小选用下面的 typedef 可避免小密钥也占用 8192 位的存储；
+// 上下文的 n^2 超过容量时构造抛出异常
+template <size_t Limbs>
+class BasicMontCiphertext {
+public:
+    static_assert(Limbs > 0 && Limbs <= MontgomeryContext::MAX_LIMBS, "Unsupported ciphertext width");
+    static const size_t LIMBS = Limbs;
+
+    // E(0) 的平凡表示（密文 1）
+    explicit BasicMontCiphertext(const MontgomeryContext& ctx);
+    BasicMontCiphertext(const MontgomeryContext& ctx, const mpz_class& ciphertext);
+
+    // 同态加法：密文相乘
+    BasicMontCiphertext& operator+=(const BasicMontCiphertext& other);
+    BasicMontCiphertext operator+(const BasicMontCiphertext& other) const;
+    // 标量乘法：密文求幂，负数标量先对密文求逆
+    BasicMontCiphertext& operator*=(const mpz_class& scalar);
+    BasicMontCiphertext operator*(const mpz_class& scalar) const;
+    BasicMontCiphertext operator-() const;
+
+    mpz_class to_mpz() const;
+    const MontgomeryContext& get_context() const { return *ctx; }
+
+private:
+    const MontgomeryContext* ctx;
+    std::array<mp_limb_t, Limbs> limbs;
+
+    static const MontgomeryContext& check_width(const MontgomeryContext& ctx);
+};
+
+// 按密钥位数命名：n^2 占 2 * bits 位
+typedef BasicMontCiphertext<2048 / GMP_NUMB_BITS> MontCiphertext1024;
+typedef BasicMontCiphertext<4096 / GMP_NUMB_BITS> MontCiphertext2048;
+typedef BasicMontCiphertext<6144 / GMP_NUMB_BITS> MontCiphertext3072;
+// 支持所有可建立上下文的密钥
+typedef BasicMontCiphertext<MontgomeryContext::MAX_LIMBS> MontCiphertext;
+
+#endif // PAILLIER_MONTGOMERY_H
@@ -0,0 +1,55 @@
+#ifndef PAILLIER_MULTI_BUFFER_H
+#define PAILLIER_MULTI_BUFFER_H
+
+#include "PaillierMontgomery.h"
+#include <gmpxx.h>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// 多缓冲模幂的实现方式，按运行时检测到的 CPU 特性选择
+enum class ModExpBackend {
+    GMP,          // 逐个 mpz_powm
+    AVX2,         // 4 路，27 位基数，_mm256_mul_epu32
+    AVX512_IFMA   // 8 路，52 位基数，vpmadd52luq/vpmadd52huq
+};
+
+// 同一模数、同一指数、不同底数的一批模幂：每个 SIMD 通道承载一个底数，
+// 所有通道执行完全相同的平方/乘法序列，适用于 r^n mod n^2（加密）和 c^(p-1) mod p^2（CRT 解密）
+class MultiBufferModExp {
+public:
+    // modulus 必须为奇数；请求的后端 CPU 不支持时抛出异常
+    explicit MultiBufferModExp(const mpz_class& modulus, ModExpBackend backend = best_backend());
+
+    // out[i] = bases[i]^exponent mod modulus，exponent >= 0，out 可以与 bases 相同
+    void pow(const mpz_class* bases, size_t count, const mpz_class& exponent, mpz_class* out) const;
+    // 按预先生成的固定指数计划执行，密钥持有的 n、p-1、q-1 计划可跨调用复用
+    void pow(const mpz_class* bases, size_t count, const FixedExponentPlan& plan, mpz_class* out) const;
+
+    ModExpBackend get_backend() const { return backend; }
+    // 每组并行计算的底数个数，批量调用按其整数倍切块可避免空通道
+    size_t lanes() const;
+
+    static bool is_supported(ModExpBackend backend);
+    // 当前 CPU 上的默认后端：支持 IFMA 时用 IFMA，否则 GMP（AVX2 需显式指定）
+    static ModExpBackend best_backend();
+    static const char* backend_name(ModExpBackend backend);
+
+private:
+    mpz_class modulus;
+    ModExpBackend backend;
+    int radix_bits;
+    size_t num_digits;              // 每个数的 digit 个数 L，满足 4 * modulus < 2^(radix_bits * L)
+    uint64_t n0_inv;                // -modulus^(-1) mod 2^radix_bits
+    std::vector<uint64_t> modulus_digits;  // 已按通道展开：digit j 的各通道连续存放
+    std::vector<uint64_t> r2_digits;       // R^2 mod modulus，按通道展开
+    std::vector<uint64_t> r_digits;        // R mod modulus（Montgomery 形式的 1），按通道展开
+    std::vector<uint64_t> one_digits;      // 普通形式的 1，用于转换回普通形式
+
+    void pow_group(const mpz_class* bases, size_t count, const FixedExponentPlan& plan, mpz_class* out,
+                   uint64_t* scratch) const;
+    void mont_mul(uint64_t* out, const uint64_t* a, const uint64_t* b, uint64_t* t) const;
+    void load_lanes(std::vector<uint64_t>& out, const mpz_class& value) const;
+};
+
+#endif // PAILLIER_MULTI_BUFFER_H
@@ -0,0 +1,111 @@
+#include "PaillierPacking.h"
+#include <algorithm>
+#include <stdexcept>
+
+// PaillierPacker implementation
+PaillierPacker::PaillierPacker(const PaillierPublicKey& public_key, int value_bits)
+    : public_key(public_key) {
+    if (value_bits <= 0) {
+        throw std::runtime_error("Packing requires a positive value bound");
+    }
+    // 槽内为 [-2^(s-1), 2^(s-1)) 的补码，多留 1 位符号
+    slot_bits = value_bits + 1;
+    // 打包后的明文绝对值必须小于 n/2，才能从 mod n 的结果还原符号
+    int modulus_bits = public_key.get_bit_length();
+    if (modulus_bits - 2 < slot_bits) {
+        throw std::runtime_error("Value bound is too large for the key modulus");
+    }
+    slots = static_cast<size_t>((modulus_bits - 2) / slot_bits);
+}
+
+std::vector<mpz_class> PaillierPacker::pack(const mpz_class* ciphertexts, size_t count) const {
+    std::vector<mpz_class> packed(packed_count(count));
+    mpz_class n_squared = public_key.get_n_squared();
+    std::shared_ptr<const MontgomeryContext> ctx = public_key.get_montgomery();
+
+    for (size_t k = 0; k < packed.size(); k++) {
+        size_t begin = k * slots;
+        size_t end = std::min(begin + slots, count);
+
+        if (ctx) {
+            // 平方链留在 Montgomery 域内
+            mp_limb_t acc[MontgomeryContext::MAX_LIMBS];
+            mp_limb_t term[MontgomeryContext::MAX_LIMBS];
+            ctx->to_montgomery(acc, ciphertexts[end - 1]);
+            for (size_t i = end - 1; i-- > begin;) {
+                for (int b = 0; b < slot_bits; b++) {
+                    ctx->sqr(acc, acc);
+                }
+                ctx->to_montgomery(term, ciphertexts[i]);
+                ctx->mul(acc, acc, term);
+            }
+            packed[k] = ctx->from_montgomery(acc);
+        } else {
+            mpz_class shift = mpz_class(1) << slot_bits;
+            mpz_class acc = ciphertexts[end - 1];
+            for (size_t i = end - 1; i-- > begin;) {
+                mpz_powm(acc.get_mpz_t(), acc.get_mpz_t(), shift.get_mpz_t(), n_squared.get_mpz_t());
+                acc *= ciphertexts[i];
+                mpz_mod(acc.get_mpz_t(), acc.get_mpz_t(), n_squared.get_mpz_t());
+            }
+            packed[k] = acc;
+        }
+    }
+    return packed;
+}
+
+void PaillierPacker::unpack(const PaillierPrivateKey& private_key, const std::vector<mpz_class>& packed,
+                            size_t count, mpz_class* out) const {
+    if (packed.size() != packed_count(count)) {
+        throw std::runtime_error("Packed ciphertext count does not match the element count");
+    }
+
+    // 占用宽度小于 p 的打包密文用 decrypt_small（只算 p 一半），其余做完整 CRT 解密
+    size_t prime_bits = mpz_sizeinbase(private_key.get_p().get_mpz_t(), 2);
+    std::vector<mpz_class> small_in, full_in;
+    std::vector<size_t> small_index, full_index;
+    for (size_t k = 0; k < packed.size(); k++) {
+        size_t used = std::min(slots, count - k * slots);
+        if (used * slot_bits + 2 <= prime_bits) {
+            small_in.push_back(packed[k]);
+            small_index.push_back(k);
+        } else {
+            full_in.push_back(packed[k]);
+            full_index.push_back(k);
+        }
+    }
+
+    std::vector<mpz_class> plain(packed.size());
+    std::vector<mpz_class> small_out(small_in.size());
+    private_key.decrypt_small_batch(small_in.data(), small_in.size(), small_out.data());
+    for (size_t i = 0; i < small_index.size(); i++) {
+        plain[small_index[i]] = small_out[i];
+    }
+    std::vector<mpz_class> full_out = private_key.decrypt_batch(full_in);
+    mpz_class n = public_key.get_n();
+    for (size_t i = 0; i < full_index.size(); i++) {
+        // 映射到 (-n/2, n/2]
+        if (2 * full_out[i] > n) {
+            full_out[i] -= n;
+        }
+        plain[full_index[i]] = full_out[i];
+    }
+
+    // 从低位逐槽取出 s 位补码，借位留给下一槽
+    mpz_class half = mpz_class(1) << (slot_bits - 1);
+    mpz_class slot_size = mpz_class(1) << slot_bits;
+    for (size_t k = 0; k < packed.size(); k++) {
+        mpz_class rest = plain[k];
+        size_t end = std::min(slots, count - k * slots);
+        for (size_t i = 0; i < end; i++) {
+            mpz_class value;
+            mpz_fdiv_r_2exp(value.get_mpz_t(), rest.get_mpz_t(), slot_bits);
+            if (value >= half) {
+                value -= slot_size;
+            }
+            rest -= value;
+            mpz_fdiv_q_2exp(rest.get_mpz_t(), rest.get_mpz_t(), slot_bits);
+            out[k * slots + i] = value;
+        }
+    }
+}
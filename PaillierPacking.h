@@ -0,0 +1,33 @@
+#ifndef PAILLIER_PACKING_H
+#define PAILLIER_PACKING_H
+
+#include "PaillierCrypto.h"
+#include <vector>
+
+// 明文槽打包：把多个小的有符号明文 v_i 合成一个密文 E(sum v_i * 2^(slot_bits * i))，
+// 持有私钥一方只需一次解密即可拆出全部 v_i
+// 每个槽要求 |v_i| < 2^value_bits（已包含盲化因子的放大），超出范围会破坏相邻槽
+class PaillierPacker {
+public:
+    PaillierPacker(const PaillierPublicKey& public_key, int value_bits);
+
+    int get_slot_bits() const { return slot_bits; }
+    // 每个打包密文的槽数
+    size_t get_slots() const { return slots; }
+    // count 个明文所需的打包密文个数
+    size_t packed_count(size_t count) const { return (count + slots - 1) / slots; }
+
+    // 打包 count 个密文：每个打包密文用 Horner 形式 (((c_k)^(2^s) * c_(k-1))^(2^s) ...) 计算，只需平方和乘法
+    std::vector<mpz_class> pack(const mpz_class* ciphertexts, size_t count) const;
+
+    // 解密打包密文并拆出 count 个有符号明文；整体宽度不超过 p 时只做 p 一半的 CRT 解密
+    void unpack(const PaillierPrivateKey& private_key, const std::vector<mpz_class>& packed, size_t count,
+                mpz_class* out) const;
+
+private:
+    PaillierPublicKey public_key;
+    int slot_bits;
+    size_t slots;
+};
+
+#endif // PAILLIER_PACKING_H
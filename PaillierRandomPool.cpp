@@ -0,0 +1,123 @@
+#include "PaillierRandomPool.h"
+#include <chrono>
+#include <stdexcept>
+
+PaillierRandomPool::PaillierRandomPool(Producer producer, const RandomPoolConfig& config)
+    : producer(std::move(producer)), config(config) {
+    if (config.capacity == 0 || config.low_water > config.capacity) {
+        throw std::runtime_error("Random pool requires 0 < capacity and low_water <= capacity");
+    }
+    if (config.num_threads < 0) {
+        throw std::runtime_error("Random pool thread count must not be negative");
+    }
+
+    for (int i = 0; i < config.num_threads; i++) {
+        workers.emplace_back(&PaillierRandomPool::worker_loop, this);
+    }
+}
+
+PaillierRandomPool::~PaillierRandomPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    refill_cv.notify_all();
+    full_cv.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+void PaillierRandomPool::worker_loop() {
+    std::unique_lock<std::mutex> lock(mutex);
+
+    while (true) {
+        refill_cv.wait(lock, [this] {
+            return stopping || (refilling && pool.size() + in_flight < config.capacity);
+        });
+        if (stopping) {
+            return;
+        }
+
+        // 计算时释放锁，多个后台线程可以并行生成
+        in_flight++;
+        lock.unlock();
+        auto start = std::chrono::steady_clock::now();
+        mpz_class value = producer();
+        auto end = std::chrono::steady_clock::now();
+        lock.lock();
+        in_flight--;
+
+        pool.push_back(std::move(value));
+        produced++;
+        busy_seconds += std::chrono::duration<double>(end - start).count();
+
+        if (pool.size() >= config.capacity) {
+            refilling = false;
+            full_cv.notify_all();
+        }
+    }
+}
+
+mpz_class PaillierRandomPool::take() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        bool hit = !pool.empty();
+        mpz_class value;
+        if (hit) {
+            value = std::move(pool.front());
+            pool.pop_front();
+        }
+
+        // 低于低水位时唤醒后台线程补充
+        if (!refilling && pool.size() < config.low_water) {
+            refilling = true;
+            refill_events++;
+            refill_cv.notify_all();
+        }
+
+        if (hit) {
+            hits++;
+            return value;
+        }
+        misses++;
+    }
+
+    // 池为空：在调用线程现场计算
+    return producer();
+}
+
+void PaillierRandomPool::wait_until_full() {
+    if (workers.empty()) {
+        // 没有后台线程时在当前线程填满
+        while (size() < config.capacity) {
+            mpz_class value = producer();
+            std::lock_guard<std::mutex> lock(mutex);
+            pool.push_back(std::move(value));
+        }
+        return;
+    }
+
+    std::unique_lock<std::mutex> lock(mutex);
+    if (!refilling && pool.size() < config.capacity) {
+        refilling = true;
+        refill_cv.notify_all();
+    }
+    full_cv.wait(lock, [this] { return stopping || pool.size() >= config.capacity; });
+}
+
+size_t PaillierRandomPool::size() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return pool.size();
+}
+
+RandomPoolStats PaillierRandomPool::get_stats() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    RandomPoolStats stats;
+    stats.hits = hits;
+    stats.misses = misses;
+    stats.produced = produced;
+    stats.refill_events = refill_events;
+    stats.busy_seconds = busy_seconds;
+    return stats;
+}
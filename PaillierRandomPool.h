@@ -0,0 +1,83 @@
+#ifndef PAILLIER_RANDOM_POOL_H
+#define PAILLIER_RANDOM_POOL_H
+
+#include <gmpxx.h>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// 随机数池配置
+struct RandomPoolConfig {
+    size_t capacity = 1024;   // 池中最多缓存的 r^n mod n^2 个数
+    size_t low_water = 256;   // 低于该数量时唤醒后台线程补充到 capacity
+    int num_threads = 1;      // 后台补充线程数
+};
+
+// 随机数池统计信息
+struct RandomPoolStats {
+    uint64_t hits = 0;            // 直接从池中取到
+    uint64_t misses = 0;          // 池为空，在调用线程现场计算
+    uint64_t produced = 0;        // 后台线程生成的总数
+    uint64_t refill_events = 0;   // 触发低水位补充的次数
+    double busy_seconds = 0.0;    // 后台线程累计计算时间
+
+    double hit_rate() const {
+        uint64_t total = hits + misses;
+        return total == 0 ? 0.0 : static_cast<double>(hits) / total;
+    }
+    // 每个后台线程每秒生成的随机数个数
+    double refill_throughput() const {
+        return busy_seconds == 0.0 ? 0.0 : produced / busy_seconds;
+    }
+};
+
+// 预计算 Paillier 加密随机因子 r^n mod n^2 的后台池，在线加密只需一次模乘
+class PaillierRandomPool {
+public:
+    // producer 计算一个新的 r^n mod n^2，需可在多个线程中同时调用
+    using Producer = std::function<mpz_class()>;
+
+    PaillierRandomPool(Producer producer, const RandomPoolConfig& config = RandomPoolConfig());
+    ~PaillierRandomPool();
+
+    PaillierRandomPool(const PaillierRandomPool&) = delete;
+    PaillierRandomPool& operator=(const PaillierRandomPool&) = delete;
+
+    // 取出一个随机因子，池为空时在当前线程现场计算
+    mpz_class take();
+
+    // 阻塞直到池被填满（用于离线预热）
+    void wait_until_full();
+
+    size_t size() const;
+    const RandomPoolConfig& get_config() const { return config; }
+    RandomPoolStats get_stats() const;
+
+private:
+    Producer producer;
+    RandomPoolConfig config;
+
+    mutable std::mutex mutex;
+    std::condition_variable refill_cv;
+    std::condition_variable full_cv;
+    std::deque<mpz_class> pool;
+    size_t in_flight = 0;
+    bool refilling = true;
+    bool stopping = false;
+
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t produced = 0;
+    uint64_t refill_events = 0;
+    double busy_seconds = 0.0;
+
+    std::vector<std::thread> workers;
+
+    void worker_loop();
+};
+
+#endif // PAILLIER_RANDOM_POOL_H
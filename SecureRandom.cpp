@@ -0,0 +1,163 @@
+#include "SecureRandom.h"
+#include <pthread.h>
+#include <sys/random.h>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+
+// AesCtrPrg implementation
+AesCtrPrg::AesCtrPrg(const unsigned char* key, const unsigned char* iv) {
+    ctx = EVP_CIPHER_CTX_new();
+    if (ctx == nullptr || EVP_EncryptInit_ex(ctx, EVP_aes_128_ctr(), nullptr, key, iv) != 1) {
+        EVP_CIPHER_CTX_free(ctx);
+        throw std::runtime_error("Failed to initialize AES-CTR generator");
+    }
+}
+
+AesCtrPrg::~AesCtrPrg() {
+    EVP_CIPHER_CTX_free(ctx);
+}
+
+void AesCtrPrg::fill(unsigned char* out, size_t len) {
+    // CTR 模式下加密全零即得到密钥流，原地加密不需要额外缓冲区
+    std::memset(out, 0, len);
+    while (len > 0) {
+        int chunk = static_cast<int>(len > (1u << 30) ? (1u << 30) : len);
+        int written = 0;
+        if (EVP_EncryptUpdate(ctx, out, &written, out, chunk) != 1) {
+            throw std::runtime_error("AES-CTR keystream generation failed");
+        }
+        out += chunk;
+        len -= chunk;
+    }
+}
+
+// 从操作系统获取种子
+static void os_random(unsigned char* out, size_t len) {
+    while (len > 0) {
+        ssize_t got = getrandom(out, len, 0);
+        if (got < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw std::runtime_error("getrandom failed");
+        }
+        out += got;
+        len -= static_cast<size_t>(got);
+    }
+}
+
+namespace {
+
+// fork 代数：子进程中由 pthread_atfork 处理函数加一，生成器据此发现自己被复制到了子进程
+std::atomic<uint64_t> fork_generation(0);
+
+void on_fork_child() {
+    fork_generation.fetch_add(1, std::memory_order_relaxed);
+}
+
+// 线程局部生成器状态：小请求从缓冲区取，大请求直接写入输出
+struct ThreadGenerator {
+    static const size_t BUFFER_SIZE = 4096;
+
+    std::unique_ptr<AesCtrPrg> prg;
+    uint64_t generation = 0;
+    unsigned char buffer[BUFFER_SIZE];
+    size_t available = 0;
+
+    void ensure_seeded() {
+        // fork 后子进程必须重新播种，否则与父进程输出相同的流。
+        // 比较 fork 代数而不是每次调用 getpid()：glibc 不再缓存 pid，每次取随机数都会多一次系统调用
+        uint64_t current = fork_generation.load(std::memory_order_relaxed);
+        if (prg && generation == current) {
+            return;
+        }
+        // 在任何线程第一次输出随机数之前注册，之后的 fork 都会被记录
+        static std::once_flag atfork_registered;
+        std::call_once(atfork_registered, [] {
+            if (pthread_atfork(nullptr, nullptr, on_fork_child) != 0) {
+                throw std::runtime_error("pthread_atfork failed");
+            }
+        });
+        unsigned char seed[2 * AesCtrPrg::KEY_SIZE];
+        os_random(seed, sizeof(seed));
+        prg.reset(new AesCtrPrg(seed, seed + AesCtrPrg::KEY_SIZE));
+        std::memset(seed, 0, sizeof(seed));
+        generation = current;
+        available = 0;
+    }
+
+    void fill(unsigned char* out, size_t len) {
+        ensure_seeded();
+        if (len >= BUFFER_SIZE) {
+            prg->fill(out, len);
+            return;
+        }
+        if (available < len) {
+            prg->fill(buffer, BUFFER_SIZE);
+            available = BUFFER_SIZE;
+        }
+        unsigned char* src = buffer + (BUFFER_SIZE - available);
+        std::memcpy(out, src, len);
+        // 已输出的随机字节立即清除
+        std::memset(src, 0, len);
+        available -= len;
+    }
+};
+
+thread_local ThreadGenerator generator;
+
+}
+
+void SecureRandom::fill_bytes(void* out, size_t len) {
+    generator.fill(static_cast<unsigned char*>(out), len);
+}
+
+void SecureRandom::fill_limbs(mp_limb_t* out, size_t count) {
+    generator.fill(reinterpret_cast<unsigned char*>(out), count * sizeof(mp_limb_t));
+}
+
+uint64_t SecureRandom::next_u64() {
+    uint64_t value;
+    generator.fill(reinterpret_cast<unsigned char*>(&value), sizeof(value));
+    return value;
+}
+
+int SecureRandom::random_sign() {
+    unsigned char byte;
+    generator.fill(&byte, 1);
+    return (byte & 1) ? 1 : -1;
+}
+
+mpz_class SecureRandom::random_bits(int bits) {
+    mpz_class result;
+    if (bits <= 0) {
+        return result;
+    }
+
+    // 直接写入 mpz 的 limb 数组，避免逐段移位拼接
+    size_t limbs = (bits + GMP_NUMB_BITS - 1) / GMP_NUMB_BITS;
+    mp_limb_t* data = mpz_limbs_write(result.get_mpz_t(), limbs);
+    fill_limbs(data, limbs);
+    int top_bits = bits % GMP_NUMB_BITS;
+    if (top_bits != 0) {
+        data[limbs - 1] &= (mp_limb_t(1) << top_bits) - 1;
+    }
+    mpz_limbs_finish(result.get_mpz_t(), limbs);
+    return result;
+}
+
+mpz_class SecureRandom::random_below(const mpz_class& bound) {
+    if (bound <= 0) {
+        throw std::runtime_error("random_below requires a positive bound");
+    }
+    int bits = mpz_sizeinbase(bound.get_mpz_t(), 2);
+    mpz_class result;
+    do {
+        result = random_bits(bits);
+    } while (result >= bound);
+    return result;
+}
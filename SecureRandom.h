@@ -0,0 +1,42 @@
+#ifndef SECURE_RANDOM_H
+#define SECURE_RANDOM_H
+
+#include <gmpxx.h>
+#include <openssl/evp.h>
+#include <cstddef>
+#include <cstdint>
+
+// AES-128-CTR 伪随机数生成器：同一 key/iv 输出确定的密钥流
+class AesCtrPrg {
+public:
+    static const size_t KEY_SIZE = 16;
+
+    AesCtrPrg(const unsigned char* key, const unsigned char* iv);
+    ~AesCtrPrg();
+
+    AesCtrPrg(const AesCtrPrg&) = delete;
+    AesCtrPrg& operator=(const AesCtrPrg&) = delete;
+
+    // 从当前流位置继续输出 len 字节
+    void fill(unsigned char* out, size_t len);
+
+private:
+    EVP_CIPHER_CTX* ctx;
+};
+
+// 进程内统一的密码学安全随机数接口
+// 每个线程持有独立的 AES-CTR 生成器，首次使用时从操作系统 (getrandom) 取种子，之后无锁调用
+namespace SecureRandom {
+    void fill_bytes(void* out, size_t len);
+    void fill_limbs(mp_limb_t* out, size_t count);
+    uint64_t next_u64();
+
+    // 等概率返回 1 或 -1
+    int random_sign();
+    // [0, 2^bits) 上均匀分布
+    mpz_class random_bits(int bits);
+    // [0, bound) 上均匀分布（拒绝采样）
+    mpz_class random_below(const mpz_class& bound);
+}
+
+#endif // SECURE_RANDOM_H
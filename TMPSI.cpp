@@ -46,6 +46,22 @@ EncryptedNumber PSIOperations::queryGarbled(const mpz_class& element, const Garb
 
 }
 
+std::vector<EncryptedNumber> PSIOperations::queryGarbledBatch(const std::vector<mpz_class>& elements,
+                                                              const GarbledBloomFilter& gbf) {
+    std::vector<std::string> elem_strs;
+    elem_strs.reserve(elements.size());
+    for (const auto& element : elements) {
+        elem_strs.push_back(element.get_str());
+    }
+    std::vector<mpz_class> results = gbf.queryBatch(elem_strs);
+    std::vector<EncryptedNumber> encrypted;
+    encrypted.reserve(results.size());
+    for (const auto& result : results) {
+        encrypted.push_back(seq_public_key.encrypt(result));
+    }
+    return encrypted;
+}
+
 void PSIOperations::generateAllGBFs(int a) {
     auto start = std::chrono::high_resolution_clock::now();
     
@@ -68,17 +84,20 @@ void PSIOperations::computeIntersection() {
         intersection.clear();
         
         for (int i = 0; i < t-1; ++i) {
+            com[i] = queryGarbledBatch(data[t-1], GBFs[i]);
             for (int j = 0; j < n; ++j) {
-                com[i][j] = queryGarbled(data[t-1][j], GBFs[i]);
                 Alpha[i][j] = SEP_TMPSI(com[i][j], one);
             }
         }
         
         std::vector<EncryptedNumber> beta(n, seq_public_key.encrypt(0));
+        std::vector<mpz_class> column(t-1);
         for (int i = 0; i < n; ++i) {
+            // 一列密文在 Montgomery 域内连乘，代替逐个 mpz 乘法取模
             for (int j = 0; j < t-1; ++j) {
-                beta[i] = beta[i] + Alpha[j][i];
+                column[j] = Alpha[j][i].getCiphertext();
             }
+            beta[i] = EncryptedNumber(PaillierHomomorphic::sum(seq_public_key, column), seq_public_key);
             
             int result = SCP(beta[i], 2 * threshold);
             if (result == 1) {
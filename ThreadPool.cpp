@@ -0,0 +1,132 @@
+#include "ThreadPool.h"
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <memory>
+
+ThreadPool::ThreadPool(int num_threads) {
+    if (num_threads <= 0) {
+        num_threads = static_cast<int>(std::thread::hardware_concurrency());
+    }
+    // 调用 parallel_for 的线程自身也参与计算，因此只需要 num_threads - 1 个工作线程
+    for (int i = 1; i < num_threads; i++) {
+        workers.emplace_back(&ThreadPool::worker_loop, this);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    task_cv.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+void ThreadPool::worker_loop() {
+    while (true) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            task_cv.wait(lock, [this] { return stopping || !tasks.empty(); });
+            if (stopping && tasks.empty()) {
+                return;
+            }
+            task = std::move(tasks.front());
+            tasks.pop_front();
+        }
+        task();
+    }
+}
+
+void ThreadPool::submit(std::function<void()> task) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        tasks.push_back(std::move(task));
+    }
+    task_cv.notify_one();
+}
+
+void ThreadPool::parallel_for(size_t count, const std::function<void(size_t, size_t)>& body, size_t grain) {
+    if (count == 0) {
+        return;
+    }
+    grain = std::max<size_t>(grain, 1);
+    size_t num_chunks = (count + grain - 1) / grain;
+
+    if (workers.empty() || num_chunks == 1) {
+        body(0, count);
+        return;
+    }
+
+    // 各线程通过原子计数领取块；任务对象由 shared_ptr 持有，晚启动的工作线程不会访问已销毁的状态
+    struct Job {
+        std::function<void(size_t, size_t)> body;
+        size_t count;
+        size_t grain;
+        size_t num_chunks;
+        std::atomic<size_t> next_chunk{0};
+        std::atomic<size_t> done_chunks{0};
+        std::mutex mutex;
+        std::condition_variable done_cv;
+        std::exception_ptr error;
+    };
+    auto job = std::make_shared<Job>();
+    job->body = body;
+    job->count = count;
+    job->grain = grain;
+    job->num_chunks = num_chunks;
+
+    auto run = [job]() {
+        while (true) {
+            size_t chunk = job->next_chunk.fetch_add(1);
+            if (chunk >= job->num_chunks) {
+                return;
+            }
+            size_t begin = chunk * job->grain;
+            size_t end = std::min(begin + job->grain, job->count);
+            try {
+                job->body(begin, end);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(job->mutex);
+                if (!job->error) {
+                    job->error = std::current_exception();
+                }
+            }
+            if (job->done_chunks.fetch_add(1) + 1 == job->num_chunks) {
+                std::lock_guard<std::mutex> lock(job->mutex);
+                job->done_cv.notify_all();
+            }
+        }
+    };
+
+    size_t helpers = std::min(workers.size(), num_chunks - 1);
+    for (size_t i = 0; i < helpers; i++) {
+        submit(run);
+    }
+    run();
+
+    std::unique_lock<std::mutex> lock(job->mutex);
+    job->done_cv.wait(lock, [&job] { return job->done_chunks.load() == job->num_chunks; });
+    if (job->error) {
+        std::rethrow_exception(job->error);
+    }
+}
+
+static std::mutex global_mutex;
+static std::unique_ptr<ThreadPool> global_pool;
+
+ThreadPool& ThreadPool::global() {
+    std::lock_guard<std::mutex> lock(global_mutex);
+    if (!global_pool) {
+        global_pool.reset(new ThreadPool());
+    }
+    return *global_pool;
+}
+
+void ThreadPool::set_global_threads(int num_threads) {
+    std::lock_guard<std::mutex> lock(global_mutex);
+    global_pool.reset(new ThreadPool(num_threads));
+}
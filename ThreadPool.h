@@ -0,0 +1,44 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// 可复用的线程池，批量加解密等数据并行操作共用
+class ThreadPool {
+public:
+    // num_threads <= 0 时取 std::thread::hardware_concurrency()
+    explicit ThreadPool(int num_threads = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    int size() const { return static_cast<int>(workers.size()) + 1; }
+
+    // 将 [0, count) 按 grain 切块，body(begin, end) 在池中并行执行，调用线程也参与计算
+    // 阻塞直到全部完成；body 抛出的第一个异常会在调用线程重新抛出
+    void parallel_for(size_t count, const std::function<void(size_t, size_t)>& body, size_t grain = 1);
+
+    // 全局共享线程池，首次使用时创建
+    static ThreadPool& global();
+    // 设置全局线程池的线程数（<= 0 表示 hardware_concurrency），不能与正在使用全局池的任务并发调用
+    static void set_global_threads(int num_threads);
+
+private:
+    std::vector<std::thread> workers;
+    std::deque<std::function<void()>> tasks;
+    std::mutex mutex;
+    std::condition_variable task_cv;
+    bool stopping = false;
+
+    void worker_loop();
+    void submit(std::function<void()> task);
+};
+
+#endif // THREAD_POOL_H
@@ -0,0 +1,376 @@
+#include "GarbledBloom.h"
+#include "GarbledBloomStore.h"
+#include "MultiBufferSha256.h"
+#include "PaillierCrypto.h"
+#include "SecureRandom.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// 与 PSIOperations 相同的元素编码：十进制字符串
+static std::vector<std::string> random_elements(size_t count) {
+    std::vector<std::string> elements(count);
+    for (size_t i = 0; i < count; ++i) {
+        elements[i] = SecureRandom::random_bits(64).get_str();
+    }
+    return elements;
+}
+
+// 旧的 10 摘要方案、逐个 SHA-256 与批量多缓冲 SHA-256 的位置计算吞吐
+static bool bench_hash_positions(const PaillierPublicKey& pk, size_t count) {
+    std::cout << "\n--- GBF position hashing benchmark (" << count << " elements) ---" << std::endl;
+
+    std::vector<std::string> elements = random_elements(count);
+    GarbledBloomFilter legacy(static_cast<int>(count), pk, GBFHashScheme::Legacy);
+    GarbledBloomFilter filter(static_cast<int>(count), pk, GBFHashScheme::SHA256);
+    const int k = filter.getNumHashes();
+    std::vector<size_t> single(count * k);
+    bool ok = true;
+
+    size_t legacy_count = std::min<size_t>(count, 20000);
+    auto start = std::chrono::high_resolution_clock::now();
+    for (size_t i = 0; i < legacy_count; ++i) {
+        legacy.computePositions(elements[i], &single[i * k]);
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    double legacy_rate = legacy_count / std::chrono::duration<double>(end - start).count();
+
+    start = std::chrono::high_resolution_clock::now();
+    for (size_t i = 0; i < count; ++i) {
+        filter.computePositions(elements[i], &single[i * k]);
+    }
+    end = std::chrono::high_resolution_clock::now();
+    double single_rate = count / std::chrono::duration<double>(end - start).count();
+
+    std::vector<size_t> batch(count * k);
+    start = std::chrono::high_resolution_clock::now();
+    filter.computePositionsBatch(elements.data(), count, batch.data());
+    end = std::chrono::high_resolution_clock::now();
+    double batch_rate = count / std::chrono::duration<double>(end - start).count();
+    ok &= (batch == single);
+
+    std::cout << "Legacy 10 digests:     " << legacy_rate / 1e6 << " M elements/s" << std::endl;
+    std::cout << "SHA-256 per element:   " << single_rate / 1e6 << " M elements/s" << std::endl;
+    std::cout << "SHA-256 batch ("
+              << MultiBufferSha256::backend_name(MultiBufferSha256::best_backend()) << "): " << batch_rate / 1e6
+              << " M elements/s (" << batch_rate / single_rate << "x)" << std::endl;
+
+    // 各后端的原始摘要吞吐
+    unsigned char key[GarbledBloomFilter::HASH_KEY_SIZE] = {0};
+    std::vector<unsigned char> reference(count * MultiBufferSha256::DIGEST_SIZE);
+    MultiBufferSha256(HashBackend::Scalar).hash(key, sizeof(key), elements.data(), count, reference.data());
+    for (HashBackend backend : {HashBackend::Scalar, HashBackend::AVX2, HashBackend::AVX512}) {
+        if (!MultiBufferSha256::is_supported(backend)) {
+            continue;
+        }
+        MultiBufferSha256 hasher(backend);
+        std::vector<unsigned char> digests(count * MultiBufferSha256::DIGEST_SIZE);
+        start = std::chrono::high_resolution_clock::now();
+        hasher.hash(key, sizeof(key), elements.data(), count, digests.data());
+        end = std::chrono::high_resolution_clock::now();
+        ok &= (digests == reference);
+        std::cout << "SHA-256 " << MultiBufferSha256::backend_name(backend) << " x" << hasher.lanes() << ": "
+                  << count / std::chrono::duration<double>(end - start).count() / 1e6 << " M digests/s" << std::endl;
+    }
+    std::cout << "Results match:         " << (ok ? "Yes" : "No") << std::endl;
+    return ok;
+}
+
+// 连续 slab 上的 SIMD 行异或查询，对比旧的 vector<mpz_class> 逐个 mpz 异或
+static bool bench_query(const PaillierPublicKey& pk, size_t count) {
+    std::cout << "\n--- GBF query benchmark (" << count << " elements, "
+              << mpz_sizeinbase(pk.get_n_squared().get_mpz_t(), 2) << "-bit ciphertexts) ---" << std::endl;
+
+    std::vector<std::string> elements = random_elements(count);
+    GarbledBloomFilter filter(static_cast<int>(count), pk);
+    filter.generate(elements, 1);
+    GBFView view = filter.getFilter();
+    std::vector<mpz_class> legacy_array(view.size());
+    for (size_t i = 0; i < view.size(); ++i) {
+        legacy_array[i] = view.slot(i);
+    }
+
+    const int k = filter.getNumHashes();
+    size_t queries = std::min<size_t>(count, 100000);
+    std::vector<size_t> positions = filter.computePositionsBatch(elements);
+    std::vector<mpz_class> expected(queries);
+    auto start = std::chrono::high_resolution_clock::now();
+    for (size_t e = 0; e < queries; ++e) {
+        mpz_class recovered = 0;
+        for (int i = 0; i < k; ++i) {
+            recovered = recovered ^ legacy_array[positions[e * k + i]];
+        }
+        expected[e] = recovered;
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    double mpz_rate = queries / std::chrono::duration<double>(end - start).count();
+
+    bool ok = true;
+    std::vector<mpz_class> results(queries);
+    start = std::chrono::high_resolution_clock::now();
+    for (size_t e = 0; e < queries; ++e) {
+        results[e] = filter.query(elements[e]);
+    }
+    end = std::chrono::high_resolution_clock::now();
+    double slab_rate = queries / std::chrono::duration<double>(end - start).count();
+    ok &= (results == expected);
+
+    std::cout << "mpz array (hash excluded): " << mpz_rate / 1e6 << " M queries/s" << std::endl;
+    std::cout << "Slab query (hash included): " << slab_rate / 1e6 << " M queries/s" << std::endl;
+    std::cout << "Results match:              " << (ok ? "Yes" : "No") << std::endl;
+    return ok;
+}
+
+// 明文 payload 下不同 share 宽度的构建/查询耗时与内存
+template <class Filter>
+static bool bench_share_width(const char* name, const std::vector<std::string>& elements) {
+    Filter filter(static_cast<int>(elements.size()));
+    size_t limbs = filter.getRowLimbs();
+    std::vector<uint64_t> payloads(elements.size() * limbs);
+    for (auto& limb : payloads) {
+        limb = SecureRandom::next_u64();
+    }
+
+    auto start = std::chrono::high_resolution_clock::now();
+    filter.generate(elements, payloads.data());
+    auto end = std::chrono::high_resolution_clock::now();
+    double build_ms = std::chrono::duration<double, std::milli>(end - start).count();
+
+    // k 个槽位在插入时都已被占用的元素无法还原 payload，属于 GBF 本身的失败率
+    size_t lost = 0;
+    bool ok_restore = true;
+    std::vector<uint64_t> out(limbs);
+    start = std::chrono::high_resolution_clock::now();
+    for (size_t e = 0; e < elements.size(); ++e) {
+        filter.query(elements[e], out.data());
+        lost += !std::equal(out.begin(), out.end(), payloads.begin() + e * limbs);
+    }
+    end = std::chrono::high_resolution_clock::now();
+    double query_rate = elements.size() / std::chrono::duration<double>(end - start).count();
+
+    // 种子压缩传输：只发送显式写入的行，接收方重新展开其余行
+    std::vector<unsigned char> compressed = filter.serializeCompressed();
+    start = std::chrono::high_resolution_clock::now();
+    Filter restored = Filter::deserializeCompressed(compressed.data(), compressed.size());
+    end = std::chrono::high_resolution_clock::now();
+    double restore_ms = std::chrono::duration<double, std::milli>(end - start).count();
+
+    GBFView view = filter.getFilter();
+    size_t slab_bytes = view.size() * view.rowLimbs() * 8;
+    ok_restore &= std::memcmp(restored.getFilter().data(), view.data(), slab_bytes) == 0;
+    std::cout << name << ": " << slab_bytes / (1024.0 * 1024.0) << " MiB, build " << build_ms << " ms, "
+              << query_rate / 1e6 << " M queries/s, " << lost << " lost, compressed "
+              << compressed.size() / (1024.0 * 1024.0) << " MiB (restore " << restore_ms << " ms)" << std::endl;
+    return ok_restore && lost * 100 < elements.size();
+}
+
+// 从 GBF 文件加载/映射与重新构建的启动耗时对比
+static bool bench_gbf_store(const PaillierPublicKey& pk, size_t count) {
+    std::cout << "\n--- GBF store benchmark (" << count << " elements) ---" << std::endl;
+    const std::string path = "bench_gbf_" + std::to_string(count) + ".gbf";
+    std::vector<std::string> elements = random_elements(count);
+
+    auto start = std::chrono::high_resolution_clock::now();
+    GarbledBloomFilter filter(static_cast<int>(count), pk);
+    filter.generate(elements, 1);
+    auto end = std::chrono::high_resolution_clock::now();
+    double build_ms = std::chrono::duration<double, std::milli>(end - start).count();
+    GarbledBloomStore::save(path, filter);
+
+    start = std::chrono::high_resolution_clock::now();
+    GarbledBloomFilter loaded = GarbledBloomStore::load<GBF_DYNAMIC_SHARE_BITS>(path);
+    end = std::chrono::high_resolution_clock::now();
+    double load_ms = std::chrono::duration<double, std::milli>(end - start).count();
+
+    start = std::chrono::high_resolution_clock::now();
+    GarbledBloomFilter mapped = GarbledBloomStore::map<GBF_DYNAMIC_SHARE_BITS>(path);
+    end = std::chrono::high_resolution_clock::now();
+    double map_ms = std::chrono::duration<double, std::milli>(end - start).count();
+
+    // 映射后的首轮查询包含缺页开销
+    bool ok = true;
+    size_t queries = std::min<size_t>(count, 10000);
+    start = std::chrono::high_resolution_clock::now();
+    for (size_t e = 0; e < queries; ++e) {
+        ok &= (mapped.query(elements[e]) == filter.query(elements[e]));
+        ok &= (loaded.query(elements[e]) == filter.query(elements[e]));
+    }
+    end = std::chrono::high_resolution_clock::now();
+    std::remove(path.c_str());
+
+    std::cout << "Generate (encrypt + build): " << build_ms << " ms" << std::endl;
+    std::cout << "Load into memory:           " << load_ms << " ms" << std::endl;
+    std::cout << "Map read-only:              " << map_ms << " ms" << std::endl;
+    std::cout << "Results match:              " << (ok ? "Yes" : "No") << std::endl;
+    return ok;
+}
+
+// 同一 seed 下单线程与全局线程池构建的耗时，结果必须逐字节相同
+template <class Filter>
+static bool bench_parallel_generate(const char* name, size_t count) {
+    std::vector<std::string> elements = random_elements(count);
+    Filter sequential(static_cast<int>(count));
+    Filter parallel = sequential;  // 相同的 hashKey
+    size_t limbs = sequential.getRowLimbs();
+    std::vector<uint64_t> payloads(count * limbs);
+    for (auto& limb : payloads) {
+        limb = SecureRandom::next_u64();
+    }
+    unsigned char seed[Filter::SEED_SIZE];
+    SecureRandom::fill_bytes(seed, sizeof(seed));
+
+    ThreadPool single(1);
+    auto start = std::chrono::high_resolution_clock::now();
+    sequential.generate(elements, payloads.data(), seed, single);
+    auto end = std::chrono::high_resolution_clock::now();
+    double single_ms = std::chrono::duration<double, std::milli>(end - start).count();
+
+    start = std::chrono::high_resolution_clock::now();
+    parallel.generate(elements, payloads.data(), seed);
+    end = std::chrono::high_resolution_clock::now();
+    double pool_ms = std::chrono::duration<double, std::milli>(end - start).count();
+
+    GBFView a = sequential.getFilter();
+    GBFView b = parallel.getFilter();
+    bool ok = std::memcmp(a.data(), b.data(), a.size() * a.rowLimbs() * 8) == 0;
+    std::cout << name << ": 1 thread " << single_ms << " ms, " << ThreadPool::global().size() << " threads "
+              << pool_ms << " ms (" << single_ms / pool_ms << "x), identical: " << (ok ? "Yes" : "No") << std::endl;
+    return ok;
+}
+
+// 批量查询（多缓冲哈希 + 预取）与逐个 query 的吞吐对比
+template <class Filter>
+static bool bench_query_batch(const char* name, size_t count) {
+    std::vector<std::string> elements = random_elements(count);
+    Filter filter(static_cast<int>(count));
+    size_t limbs = filter.getRowLimbs();
+    std::vector<uint64_t> payloads(count * limbs);
+    for (auto& limb : payloads) {
+        limb = SecureRandom::next_u64();
+    }
+    filter.generate(elements, payloads.data());
+
+    // 查询集合内元素，顺序打乱，避免与插入顺序相关的缓存局部性
+    std::vector<std::string> queries = elements;
+    for (size_t i = queries.size(); i > 1; --i) {
+        std::swap(queries[i - 1], queries[SecureRandom::next_u64() % i]);
+    }
+    size_t total = std::min<size_t>(count, 200000);
+
+    std::vector<uint64_t> single(total * limbs);
+    auto start = std::chrono::high_resolution_clock::now();
+    for (size_t e = 0; e < total; ++e) {
+        filter.query(queries[e], &single[e * limbs]);
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    double single_rate = total / std::chrono::duration<double>(end - start).count();
+
+    std::vector<uint64_t> batch(total * limbs);
+    start = std::chrono::high_resolution_clock::now();
+    filter.queryBatch(queries.data(), total, batch.data());
+    end = std::chrono::high_resolution_clock::now();
+    double batch_rate = total / std::chrono::duration<double>(end - start).count();
+
+    bool ok = (single == batch);
+    std::cout << name << " n=" << count << ": query " << single_rate / 1e6 << " M/s, queryBatch "
+              << batch_rate / 1e6 << " M/s (" << batch_rate / single_rate << "x)" << (ok ? "" : " MISMATCH")
+              << std::endl;
+    return ok;
+}
+
+// 按误判率选参：m/n、k、理论误判率、空槽比例、插入失败数，以及构建与查询速度
+static bool bench_sizing(const char* name, const std::vector<std::string>& elements, const GBFSizingPolicy& policy) {
+    size_t count = elements.size();
+    GarbledBloomFilter128 filter(static_cast<int>(count), policy);
+    std::vector<uint64_t> payloads(count * GarbledBloomFilter128::ROW_LIMBS);
+    for (auto& limb : payloads) {
+        limb = SecureRandom::next_u64();
+    }
+    auto start = std::chrono::high_resolution_clock::now();
+    filter.generate(elements, payloads.data());
+    auto end = std::chrono::high_resolution_clock::now();
+    double build_ms = std::chrono::duration<double, std::milli>(end - start).count();
+
+    std::vector<uint64_t> out(count * GarbledBloomFilter128::ROW_LIMBS);
+    start = std::chrono::high_resolution_clock::now();
+    filter.queryBatch(elements.data(), count, out.data());
+    end = std::chrono::high_resolution_clock::now();
+    double query_rate = count / std::chrono::duration<double>(end - start).count();
+
+    // 插入失败的元素查不到自己的 payload
+    size_t lost = 0;
+    for (size_t e = 0; e < count; ++e) {
+        const uint64_t* got = &out[e * GarbledBloomFilter128::ROW_LIMBS];
+        if (!std::equal(got, got + GarbledBloomFilter128::ROW_LIMBS, &payloads[e * GarbledBloomFilter128::ROW_LIMBS])) {
+            ++lost;
+        }
+    }
+    const GBFBuildStats& stats = filter.getBuildStats();
+    double expected = GarbledBloomBase::computeSizing(count, GarbledBloomFilter128::ROW_LIMBS * sizeof(uint64_t), policy)
+                          .expected_false_positive_rate;
+    double mib = filter.size() * GarbledBloomFilter128::ROW_LIMBS * sizeof(uint64_t) / (1024.0 * 1024.0);
+    std::cout << name << ": k=" << filter.getNumHashes() << ", m/n=" << stats.slots_per_element << " (" << mib
+              << " MiB), expected FPR " << expected << ", empty " << stats.empty_slot_ratio * 100 << "%, failed "
+              << stats.failed_inserts << ", build " << build_ms << " ms, queryBatch " << query_rate / 1e6 << " M/s"
+              << std::endl;
+    return lost == stats.failed_inserts;
+}
+
+int main() {
+    try {
+        PaillierKeyPair key_pair = PaillierKeyPair::generate(1024);
+        PaillierPublicKey pk = key_pair.get_public_key();
+
+        bool ok = true;
+        ok &= bench_hash_positions(pk, 100000);
+        ok &= bench_hash_positions(pk, 1000000);
+        ok &= bench_query(pk, 100000);
+
+        ok &= bench_gbf_store(pk, 20000);
+
+        std::cout << "\n--- GBF share width benchmark (100000 elements, plaintext payloads) ---" << std::endl;
+        std::vector<std::string> elements = random_elements(100000);
+        ok &= bench_share_width<GarbledBloomFilter128>("128-bit  ", elements);
+        ok &= bench_share_width<GarbledBloomFilter256>("256-bit  ", elements);
+        ok &= bench_share_width<GarbledBloomFilter2048>("2048-bit ", elements);
+        ok &= bench_share_width<GarbledBloomFilter>("dynamic  ", elements);
+
+        std::cout << "\n--- GBF parallel generate benchmark (plaintext payloads) ---" << std::endl;
+        ok &= bench_parallel_generate<GarbledBloomFilter128>("128-bit,  1000000 elements", 1000000);
+        ok &= bench_parallel_generate<GarbledBloomFilter2048>("2048-bit, 100000 elements ", 100000);
+
+        std::cout << "\n--- GBF batch query benchmark (member queries, shuffled) ---" << std::endl;
+        for (size_t count : {10000, 100000, 1000000}) {
+            ok &= bench_query_batch<GarbledBloomFilter128>("128-bit ", count);
+        }
+        for (size_t count : {10000, 100000, 1000000}) {
+            ok &= bench_query_batch<GarbledBloomFilter256>("256-bit ", count);
+        }
+        for (size_t count : {10000, 100000}) {
+            ok &= bench_query_batch<GarbledBloomFilter2048>("2048-bit", count);
+        }
+
+        std::cout << "\n--- GBF sizing benchmark (128-bit, 100000 elements) ---" << std::endl;
+        GBFSizingPolicy policy;
+        ok &= bench_sizing("p=1/1024 (default)", elements, policy);
+        for (double p : {1e-2, 1e-3, 1e-4, 1e-6}) {
+            policy.false_positive_rate = p;
+            std::ostringstream name;
+            name << "p=" << p;
+            ok &= bench_sizing(name.str().c_str(), elements, policy);
+        }
+        policy.false_positive_rate = 1e-6;
+        policy.memory_budget = 8 << 20;
+        ok &= bench_sizing("p=1e-06, 8 MiB budget", elements, policy);
+        return ok ? 0 : 1;
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+}
@@ -0,0 +1,746 @@
+#include "PaillierCrypto.h"
+#include "PaillierKeyGen.h"
+#include "PaillierMultiBuffer.h"
+#include "PaillierPacking.h"
+#include "seq.h"
+#include <algorithm>
+#include <cstdio>
+#include <string>
+#include <chrono>
+#include <iostream>
+#include <vector>
+
+// 对给定密钥长度比较 Reference 解密与 CRT 解密
+static bool bench_decrypt(int key_bits, int rounds) {
+    std::cout << "\n--- Decrypt benchmark (" << key_bits << " bits, "
+              << rounds << " ciphertexts) ---" << std::endl;
+
+    PaillierKeyPair key_pair = PaillierKeyPair::generate(key_bits);
+    PaillierPublicKey public_key = key_pair.get_public_key();
+    PaillierPrivateKey private_key = key_pair.get_private_key();
+
+    std::vector<mpz_class> messages, ciphertexts;
+    for (int i = 0; i < rounds; ++i) {
+        messages.push_back(mpz_class(i * 7919 + 1));
+        ciphertexts.push_back(public_key.encrypt(messages.back()));
+    }
+
+    auto start = std::chrono::high_resolution_clock::now();
+    std::vector<mpz_class> reference;
+    for (const auto& c : ciphertexts) {
+        reference.push_back(private_key.decrypt(c, DecryptMode::Reference));
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    auto reference_us = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+
+    start = std::chrono::high_resolution_clock::now();
+    std::vector<mpz_class> crt;
+    for (const auto& c : ciphertexts) {
+        crt.push_back(private_key.decrypt(c, DecryptMode::CRT));
+    }
+    end = std::chrono::high_resolution_clock::now();
+    auto crt_us = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+
+    // 小明文（有符号）解密，模拟 SEP/SCP 的符号判断
+    std::vector<mpz_class> small_messages, small_ciphertexts;
+    for (int i = 0; i < rounds; ++i) {
+        small_messages.push_back(mpz_class(i % 2 ? 2 * i + 1 : -(2 * i + 1)));
+        small_ciphertexts.push_back(public_key.encrypt(small_messages.back()));
+    }
+
+    start = std::chrono::high_resolution_clock::now();
+    std::vector<mpz_class> small;
+    for (const auto& c : small_ciphertexts) {
+        small.push_back(private_key.decrypt_small(c));
+    }
+    end = std::chrono::high_resolution_clock::now();
+    auto small_us = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+
+    bool ok = true;
+    for (int i = 0; i < rounds; ++i) {
+        if (reference[i] != messages[i] || crt[i] != messages[i] || small[i] != small_messages[i]) {
+            ok = false;
+        }
+    }
+
+    std::cout << "Reference decrypt: " << reference_us / rounds << "us/op" << std::endl;
+    std::cout << "CRT decrypt:       " << crt_us / rounds << "us/op" << std::endl;
+    std::cout << "Small decrypt:     " << small_us / rounds << "us/op" << std::endl;
+    std::cout << "Speedup:           " << static_cast<double>(reference_us) / crt_us << "x (CRT), "
+              << static_cast<double>(reference_us) / small_us << "x (small)" << std::endl;
+    std::cout << "Results match:     " << (ok ? "Yes" : "No") << std::endl;
+    return ok;
+}
+
+// 比较现场计算 r^n 与从后台随机数池取 r^n 的加密耗时
+static bool bench_random_pool(int key_bits, int rounds) {
+    std::cout << "\n--- Random pool benchmark (" << key_bits << " bits, "
+              << rounds << " encryptions) ---" << std::endl;
+
+    PaillierKeyPair key_pair = PaillierKeyPair::generate(key_bits);
+    PaillierPublicKey plain_key = key_pair.get_public_key();
+    PaillierPublicKey pooled_key = key_pair.get_public_key();
+    PaillierPrivateKey private_key = key_pair.get_private_key();
+
+    RandomPoolConfig config;
+    config.capacity = rounds;
+    config.low_water = rounds / 4;
+    config.num_threads = 2;
+    pooled_key.enable_random_pool(config);
+    pooled_key.get_random_pool()->wait_until_full();
+
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < rounds; ++i) {
+        plain_key.encrypt(mpz_class(i));
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    auto plain_us = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+
+    bool ok = true;
+    start = std::chrono::high_resolution_clock::now();
+    std::vector<mpz_class> ciphertexts;
+    for (int i = 0; i < rounds; ++i) {
+        ciphertexts.push_back(pooled_key.encrypt(mpz_class(i)));
+    }
+    end = std::chrono::high_resolution_clock::now();
+    auto pooled_us = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+
+    for (int i = 0; i < rounds; ++i) {
+        if (private_key.decrypt(ciphertexts[i]) != i) {
+            ok = false;
+        }
+    }
+
+    RandomPoolStats stats = pooled_key.get_random_pool()->get_stats();
+    std::cout << "Online r^n encrypt: " << plain_us / rounds << "us/op" << std::endl;
+    std::cout << "Pooled encrypt:     " << pooled_us / rounds << "us/op" << std::endl;
+    std::cout << "Pool hit rate:      " << stats.hit_rate() * 100 << "% ("
+              << stats.hits << " hits, " << stats.misses << " misses)" << std::endl;
+    std::cout << "Refill events:      " << stats.refill_events << std::endl;
+    std::cout << "Refill throughput:  " << stats.refill_throughput() << " r^n/s per thread" << std::endl;
+    std::cout << "Results match:      " << (ok ? "Yes" : "No") << std::endl;
+    return ok;
+}
+
+// 固定基短指数加密与 encrypt_raw（完整长度指数 r^n）的对比，以及不同窗口的内存/速度权衡
+static bool bench_fixed_base(int key_bits, int rounds) {
+    std::cout << "\n--- Fixed-base benchmark (" << key_bits << " bits, "
+              << rounds << " encryptions) ---" << std::endl;
+
+    PaillierKeyPair key_pair = PaillierKeyPair::generate(key_bits);
+    PaillierPublicKey public_key = key_pair.get_public_key();
+    PaillierPrivateKey private_key = key_pair.get_private_key();
+    mpz_class n = public_key.get_n();
+
+    std::vector<mpz_class> rs;
+    for (int i = 0; i < rounds; ++i) {
+        rs.push_back(PaillierUtil::random_r(n));
+    }
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < rounds; ++i) {
+        public_key.encrypt_raw(mpz_class(i), rs[i]);
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    auto raw_us = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+    std::cout << "encrypt_raw:          " << raw_us / rounds << "us/op" << std::endl;
+
+    bool ok = true;
+    for (int window : {4, 6, 8}) {
+        PaillierPublicKey fixed_key = key_pair.get_public_key();
+        FixedBaseConfig config;
+        config.window_bits = window;
+
+        start = std::chrono::high_resolution_clock::now();
+        fixed_key.enable_fixed_base(config);
+        end = std::chrono::high_resolution_clock::now();
+        auto build_ms = std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
+
+        start = std::chrono::high_resolution_clock::now();
+        std::vector<mpz_class> ciphertexts;
+        for (int i = 0; i < rounds; ++i) {
+            ciphertexts.push_back(fixed_key.encrypt(mpz_class(i)));
+        }
+        end = std::chrono::high_resolution_clock::now();
+        auto fixed_us = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+
+        for (int i = 0; i < rounds; ++i) {
+            if (private_key.decrypt(ciphertexts[i]) != i) {
+                ok = false;
+            }
+        }
+
+        auto table = fixed_key.get_fixed_base();
+        std::cout << "fixed-base w=" << window << " (alpha " << table->get_exponent_bits() << " bits): "
+                  << fixed_us / rounds << "us/op, speedup "
+                  << static_cast<double>(raw_us) / fixed_us << "x, table "
+                  << table->memory_bytes() / 1024 << "KB, build " << build_ms << "ms" << std::endl;
+    }
+    std::cout << "Results match:        " << (ok ? "Yes" : "No") << std::endl;
+    return ok;
+}
+
+// 逐个加解密与线程池批量加解密的对比
+static bool bench_batch(int key_bits, int rounds) {
+    std::cout << "\n--- Batch benchmark (" << key_bits << " bits, " << rounds << " elements, "
+              << ThreadPool::global().size() << " threads) ---" << std::endl;
+
+    PaillierKeyPair key_pair = PaillierKeyPair::generate(key_bits);
+    PaillierPublicKey public_key = key_pair.get_public_key();
+    PaillierPrivateKey private_key = key_pair.get_private_key();
+
+    std::vector<mpz_class> messages;
+    for (int i = 0; i < rounds; ++i) {
+        messages.push_back(mpz_class(i * 31 + 7));
+    }
+
+    auto start = std::chrono::high_resolution_clock::now();
+    std::vector<mpz_class> serial;
+    for (const auto& m : messages) {
+        serial.push_back(private_key.decrypt(public_key.encrypt(m)));
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    auto serial_ms = std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
+
+    start = std::chrono::high_resolution_clock::now();
+    std::vector<mpz_class> ciphertexts(rounds), batch(rounds);
+    public_key.encrypt_batch(messages.data(), rounds, ciphertexts.data());
+    private_key.decrypt_batch(ciphertexts.data(), rounds, batch.data());
+    end = std::chrono::high_resolution_clock::now();
+    auto batch_ms = std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
+
+    bool ok = (serial == messages) && (batch == messages);
+    std::cout << "Serial encrypt+decrypt: " << serial_ms << "ms" << std::endl;
+    std::cout << "Batch encrypt+decrypt:  " << batch_ms << "ms" << std::endl;
+    std::cout << "Results match:          " << (ok ? "Yes" : "No") << std::endl;
+    return ok;
+}
+
+// 多缓冲模幂各后端与逐个 mpz_powm 的对比，以及批量加解密接口上的效果
+static bool bench_multi_buffer(int key_bits, int rounds) {
+    std::cout << "\n--- Multi-buffer modexp benchmark (" << key_bits << " bits, " << rounds
+              << " elements, default backend "
+              << MultiBufferModExp::backend_name(MultiBufferModExp::best_backend()) << ") ---" << std::endl;
+
+    PaillierKeyPair key_pair = PaillierKeyPair::generate(key_bits);
+    PaillierPublicKey public_key = key_pair.get_public_key();
+    PaillierPrivateKey private_key = key_pair.get_private_key();
+    mpz_class n = public_key.get_n();
+    mpz_class n_squared = public_key.get_n_squared();
+
+    std::vector<mpz_class> bases(rounds), expected(rounds), result(rounds);
+    for (int i = 0; i < rounds; ++i) {
+        bases[i] = PaillierUtil::random_r(n);
+    }
+
+    bool ok = true;
+    double gmp_us = 0;
+    for (ModExpBackend backend : {ModExpBackend::GMP, ModExpBackend::AVX2, ModExpBackend::AVX512_IFMA}) {
+        if (!MultiBufferModExp::is_supported(backend)) {
+            std::cout << MultiBufferModExp::backend_name(backend) << ": not supported" << std::endl;
+            continue;
+        }
+        MultiBufferModExp modexp(n_squared, backend);
+        auto start = std::chrono::high_resolution_clock::now();
+        modexp.pow(bases.data(), rounds, n, result.data());
+        auto end = std::chrono::high_resolution_clock::now();
+        double us = std::chrono::duration<double, std::micro>(end - start).count() / rounds;
+        if (backend == ModExpBackend::GMP) {
+            gmp_us = us;
+            expected = result;
+        }
+        ok &= (result == expected);
+        std::cout << "r^n mod n^2, " << MultiBufferModExp::backend_name(backend) << ": " << us << "us/op ("
+                  << gmp_us / us << "x)" << std::endl;
+    }
+
+    // 批量接口：逐个加解密 vs encrypt_batch/decrypt_batch（单线程，只比较模幂内核）
+    ThreadPool single(1);
+    std::vector<mpz_class> messages(rounds), ciphertexts(rounds), decrypted(rounds);
+    for (int i = 0; i < rounds; ++i) {
+        messages[i] = i * 97 + 3;
+    }
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < rounds; ++i) {
+        ciphertexts[i] = public_key.encrypt(messages[i]);
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    double encrypt_us = std::chrono::duration<double, std::micro>(end - start).count() / rounds;
+
+    start = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < rounds; ++i) {
+        decrypted[i] = private_key.decrypt(ciphertexts[i]);
+    }
+    end = std::chrono::high_resolution_clock::now();
+    double decrypt_us = std::chrono::duration<double, std::micro>(end - start).count() / rounds;
+    ok &= (decrypted == messages);
+
+    start = std::chrono::high_resolution_clock::now();
+    public_key.encrypt_batch(messages.data(), rounds, ciphertexts.data(), single);
+    end = std::chrono::high_resolution_clock::now();
+    double encrypt_batch_us = std::chrono::duration<double, std::micro>(end - start).count() / rounds;
+
+    start = std::chrono::high_resolution_clock::now();
+    private_key.decrypt_batch(ciphertexts.data(), rounds, decrypted.data(), single);
+    end = std::chrono::high_resolution_clock::now();
+    double decrypt_batch_us = std::chrono::duration<double, std::micro>(end - start).count() / rounds;
+    ok &= (decrypted == messages);
+
+    std::cout << "Encrypt:       " << encrypt_us << "us/op, batch " << encrypt_batch_us << "us/op ("
+              << encrypt_us / encrypt_batch_us << "x)" << std::endl;
+    std::cout << "CRT decrypt:   " << decrypt_us << "us/op, batch " << decrypt_batch_us << "us/op ("
+              << decrypt_us / decrypt_batch_us << "x)" << std::endl;
+    std::cout << "Results match: " << (ok ? "Yes" : "No") << std::endl;
+    return ok;
+}
+
+// 公钥加密与持有私钥一方的 CRT 加密对比
+static bool bench_private_encrypt(int key_bits, int rounds) {
+    std::cout << "\n--- Private-key encrypt benchmark (" << key_bits << " bits, "
+              << rounds << " encryptions) ---" << std::endl;
+
+    PaillierKeyPair key_pair = PaillierKeyPair::generate(key_bits);
+    PaillierPublicKey public_key = key_pair.get_public_key();
+    PaillierPrivateKey private_key = key_pair.get_private_key();
+    mpz_class n = public_key.get_n();
+
+    std::vector<mpz_class> rs;
+    for (int i = 0; i < rounds; ++i) {
+        rs.push_back(PaillierUtil::random_r(n));
+    }
+
+    auto start = std::chrono::high_resolution_clock::now();
+    std::vector<mpz_class> public_ct;
+    for (int i = 0; i < rounds; ++i) {
+        public_ct.push_back(public_key.encrypt(mpz_class(-i), rs[i]));
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    auto public_us = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+
+    start = std::chrono::high_resolution_clock::now();
+    std::vector<mpz_class> private_ct;
+    for (int i = 0; i < rounds; ++i) {
+        private_ct.push_back(private_key.encrypt(mpz_class(-i), rs[i]));
+    }
+    end = std::chrono::high_resolution_clock::now();
+    auto private_us = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+
+    // 不指定 r：私钥方直接在 p-1、q-1 阶子群上取随机因子
+    start = std::chrono::high_resolution_clock::now();
+    std::vector<mpz_class> fresh_ct;
+    for (int i = 0; i < rounds; ++i) {
+        fresh_ct.push_back(private_key.encrypt(mpz_class(-i)));
+    }
+    end = std::chrono::high_resolution_clock::now();
+    auto fresh_us = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+
+    // 相同的 r 应得到完全相同的密文
+    bool ok = (public_ct == private_ct);
+    for (int i = 0; i < rounds; ++i) {
+        if (private_key.decrypt_small(fresh_ct[i]) != -i) {
+            ok = false;
+        }
+    }
+    std::cout << "Public-key encrypt:  " << public_us / rounds << "us/op" << std::endl;
+    std::cout << "Private-key encrypt: " << private_us / rounds << "us/op (given r), "
+              << fresh_us / rounds << "us/op (fresh r)" << std::endl;
+    std::cout << "Speedup:             " << static_cast<double>(public_us) / private_us << "x (given r), "
+              << static_cast<double>(public_us) / fresh_us << "x (fresh r)" << std::endl;
+    std::cout << "Results match:       " << (ok ? "Yes" : "No") << std::endl;
+    return ok;
+}
+
+// 密钥生成延迟分布：串行 generate_prime 与并行筛选搜索
+static void print_latency(const char* label, std::vector<double> ms) {
+    std::sort(ms.begin(), ms.end());
+    std::cout << label << "min " << ms.front() << "ms, median " << ms[ms.size() / 2]
+              << "ms, p90 " << ms[ms.size() * 9 / 10] << "ms, max " << ms.back() << "ms" << std::endl;
+}
+
+static bool bench_keygen(int key_bits, int runs) {
+    std::cout << "\n--- Keygen latency (" << key_bits << " bits, " << runs << " runs) ---" << std::endl;
+
+    std::vector<double> serial_ms, sieved_ms;
+    bool ok = true;
+    for (int i = 0; i < runs; ++i) {
+        auto start = std::chrono::high_resolution_clock::now();
+        PaillierKeyPair serial = PaillierKeyPair::generate_serial(key_bits);
+        auto end = std::chrono::high_resolution_clock::now();
+        serial_ms.push_back(std::chrono::duration<double, std::milli>(end - start).count());
+
+        KeyGenStats stats;
+        start = std::chrono::high_resolution_clock::now();
+        PaillierKeyPair sieved = PaillierKeyGen::generate(key_bits, KeyGenConfig(), &stats);
+        end = std::chrono::high_resolution_clock::now();
+        sieved_ms.push_back(std::chrono::duration<double, std::milli>(end - start).count());
+
+        PaillierPublicKey pk = sieved.get_public_key();
+        if (pk.get_bit_length() != key_bits || sieved.get_private_key().decrypt(pk.encrypt(7)) != 7) {
+            ok = false;
+        }
+    }
+
+    print_latency("Serial generate_prime: ", serial_ms);
+    print_latency("Parallel sieved:       ", sieved_ms);
+    std::cout << "Keys valid:            " << (ok ? "Yes" : "No") << std::endl;
+    return ok;
+}
+
+// 从密钥文件加载与重新生成密钥的启动耗时对比
+static bool bench_key_store(int key_bits) {
+    std::cout << "\n--- Key store benchmark (" << key_bits << " bits) ---" << std::endl;
+    const std::string path = "bench_paillier_" + std::to_string(key_bits) + ".key";
+
+    auto start = std::chrono::high_resolution_clock::now();
+    PaillierKeyPair generated = PaillierKeyPair::generate(key_bits);
+    generated.enable_fixed_base();
+    auto end = std::chrono::high_resolution_clock::now();
+    auto generate_ms = std::chrono::duration<double, std::milli>(end - start).count();
+    generated.save(path);
+
+    start = std::chrono::high_resolution_clock::now();
+    PaillierKeyPair loaded = PaillierKeyPair::load(path);
+    end = std::chrono::high_resolution_clock::now();
+    auto load_ms = std::chrono::duration<double, std::milli>(end - start).count();
+    std::remove(path.c_str());
+
+    // 加载的密钥可以解密原密钥的密文，固定基表也被完整恢复
+    mpz_class c = generated.get_public_key().encrypt(mpz_class(-12345));
+    mpz_class c_loaded = loaded.get_public_key().encrypt(mpz_class(777));
+    bool ok = loaded.get_private_key().decrypt_small(c) == -12345 &&
+              generated.get_private_key().decrypt(c_loaded) == 777 &&
+              loaded.get_public_key().get_fixed_base() != nullptr;
+
+    std::cout << "Generate + precompute: " << generate_ms << "ms" << std::endl;
+    std::cout << "Load from key file:    " << load_ms << "ms" << std::endl;
+    std::cout << "Results match:         " << (ok ? "Yes" : "No") << std::endl;
+    return ok;
+}
+
+// 密文累加与标量乘法：mpz 乘法取模链 vs Montgomery 域定宽密文
+static bool bench_montgomery(int key_bits, int terms, int rounds) {
+    std::cout << "\n--- Montgomery accumulate benchmark (" << key_bits << " bits, "
+              << terms << " terms x " << rounds << " rounds) ---" << std::endl;
+
+    PaillierKeyPair key_pair = PaillierKeyPair::generate(key_bits);
+    PaillierPublicKey public_key = key_pair.get_public_key();
+    PaillierPrivateKey private_key = key_pair.get_private_key();
+
+    std::vector<mpz_class> ciphertexts(terms);
+    mpz_class expected = 0;
+    for (int i = 0; i < terms; ++i) {
+        mpz_class m = (i % 3 == 0) ? -(i + 1) : (i + 1);
+        expected += m;
+        ciphertexts[i] = private_key.encrypt(m);
+    }
+
+    auto start = std::chrono::high_resolution_clock::now();
+    mpz_class chained;
+    for (int r = 0; r < rounds; ++r) {
+        chained = ciphertexts[0];
+        for (int i = 1; i < terms; ++i) {
+            chained = PaillierHomomorphic::add(public_key, chained, ciphertexts[i]);
+        }
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    auto chained_us = std::chrono::duration<double, std::micro>(end - start).count();
+
+    start = std::chrono::high_resolution_clock::now();
+    mpz_class summed;
+    for (int r = 0; r < rounds; ++r) {
+        summed = PaillierHomomorphic::sum(public_key, ciphertexts);
+    }
+    end = std::chrono::high_resolution_clock::now();
+    auto summed_us = std::chrono::duration<double, std::micro>(end - start).count();
+
+    // SEP 形式的小表达式 ((x - y) * 2) * s + E(-s)，在 Montgomery 域内完成
+    const MontgomeryContext& ctx = *public_key.get_montgomery();
+    MontCiphertext x(ctx, ciphertexts[0]), y(ctx, ciphertexts[1]), e(ctx, ciphertexts[2]);
+    start = std::chrono::high_resolution_clock::now();
+    MontCiphertext expr(ctx);
+    for (int r = 0; r < rounds; ++r) {
+        expr = ((x + (-y)) * mpz_class(2)) * mpz_class(-1) + e;
+    }
+    end = std::chrono::high_resolution_clock::now();
+    auto expr_us = std::chrono::duration<double, std::micro>(end - start).count();
+
+    bool ok = chained == summed && private_key.decrypt_small(summed) == expected &&
+              private_key.decrypt_small(expr.to_mpz()) == -2 * (-1 - 2) + 3;
+
+    std::cout << "mpz mul + mod chain: " << chained_us / rounds << "us/sum" << std::endl;
+    std::cout << "Montgomery product:  " << summed_us / rounds << "us/sum" << std::endl;
+    std::cout << "Speedup:             " << chained_us / summed_us << "x" << std::endl;
+    std::cout << "SEP-style expr:      " << expr_us / rounds << "us/op" << std::endl;
+    std::cout << "Results match:       " << (ok ? "Yes" : "No") << std::endl;
+    return ok;
+}
+
+// SEP 中的 ((x - y) * 2) * s + E(-s)：逐步 mpz_powm 与表达式一次求值的对比
+static bool bench_sep_expression(int key_bits, int rounds) {
+    std::cout << "\n--- SEP expression benchmark (" << key_bits << " bits, " << rounds << " rounds) ---" << std::endl;
+
+    PaillierKeyPair key_pair = PaillierKeyPair::generate(key_bits);
+    PaillierPublicKey pk = key_pair.get_public_key();
+    PaillierPrivateKey sk = key_pair.get_private_key();
+
+    EncryptedNumber x(sk.encrypt(42), pk);
+    EncryptedNumber y(sk.encrypt(17), pk);
+    EncryptedNumber enc_s[2] = {EncryptedNumber(sk.encrypt(1), pk), EncryptedNumber(sk.encrypt(-1), pk)};
+    mpz_class r1 = 2;
+    std::vector<mpz_class> eager(rounds), fused(rounds);
+
+    // 原先的逐步计算：取负、乘 2、乘 s 各一次 mpz_powm
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < rounds; ++i) {
+        int s1 = (i % 2) ? 1 : -1;
+        mpz_class y_neg = PaillierHomomorphic::multiply_scalar(pk, y.getCiphertext(), -1);
+        mpz_class diff = PaillierHomomorphic::add(pk, x.getCiphertext(), y_neg);
+        mpz_class scaled = PaillierHomomorphic::multiply_scalar(pk, diff, r1);
+        scaled = PaillierHomomorphic::multiply_scalar(pk, scaled, s1);
+        eager[i] = PaillierHomomorphic::add(pk, scaled, enc_s[i % 2].getCiphertext());
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    double eager_us = std::chrono::duration<double, std::micro>(end - start).count() / rounds;
+
+    start = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < rounds; ++i) {
+        int s1 = (i % 2) ? 1 : -1;
+        EncryptedNumber a = ((x + (-y)) * r1) * s1 + enc_s[i % 2];
+        fused[i] = a.getCiphertext();
+    }
+    end = std::chrono::high_resolution_clock::now();
+    double fused_us = std::chrono::duration<double, std::micro>(end - start).count() / rounds;
+
+    // 两种计算的密文完全相同，明文为 (42 - 17) * 2 * s - s
+    bool ok = (eager == fused);
+    for (int i = 0; i < 2; ++i) {
+        int s1 = (i % 2) ? 1 : -1;
+        ok &= sk.decrypt_small(fused[i]) == (42 - 17) * 2 * s1 - s1;
+    }
+
+    start = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < rounds; ++i) {
+        ok &= SEP_MPSI(x, y, sk).getCiphertext() != 0;
+    }
+    end = std::chrono::high_resolution_clock::now();
+    double sep_us = std::chrono::duration<double, std::micro>(end - start).count() / rounds;
+
+    std::cout << "Step-by-step mpz_powm: " << eager_us << "us/op" << std::endl;
+    std::cout << "Fused expression:      " << fused_us << "us/op (" << eager_us / fused_us << "x)" << std::endl;
+    std::cout << "SEP_MPSI call:         " << sep_us << "us/op" << std::endl;
+    std::cout << "Results match:         " << (ok ? "Yes" : "No") << std::endl;
+    return ok;
+}
+
+// 逐个 SEP_MPSI/SCP 与打包后批量解密的对比
+static bool bench_packing(int key_bits, int count) {
+    std::cout << "\n--- Packed SEP/SCP benchmark (" << key_bits << " bits, " << count << " elements) ---" << std::endl;
+
+    PaillierKeyPair key_pair = PaillierKeyPair::generate(key_bits);
+    PaillierPublicKey pk = key_pair.get_public_key();
+    PaillierPrivateKey sk = key_pair.get_private_key();
+
+    std::vector<EncryptedNumber> xs, ys;
+    std::vector<int> xs_plain(count), ys_plain(count);
+    for (int i = 0; i < count; ++i) {
+        xs_plain[i] = i % 5;
+        ys_plain[i] = (i * 7) % 5;
+        xs.push_back(EncryptedNumber(sk.encrypt(xs_plain[i]), pk));
+        ys.push_back(EncryptedNumber(sk.encrypt(ys_plain[i]), pk));
+    }
+    mpz_class threshold = 3;
+
+    auto start = std::chrono::high_resolution_clock::now();
+    std::vector<EncryptedNumber> single;
+    std::vector<mpz_class> single_scp;
+    for (int i = 0; i < count; ++i) {
+        single.push_back(SEP_MPSI(xs[i], ys[i], sk));
+        single_scp.push_back(SCP(xs[i], threshold, sk));
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    double single_ms = std::chrono::duration<double, std::milli>(end - start).count();
+
+    start = std::chrono::high_resolution_clock::now();
+    std::vector<EncryptedNumber> batch = SEP_MPSI_batch(xs, ys, sk, 8);
+    std::vector<mpz_class> batch_scp = SCP_batch(xs, threshold, sk, 8);
+    end = std::chrono::high_resolution_clock::now();
+    double batch_ms = std::chrono::duration<double, std::milli>(end - start).count();
+
+    bool ok = (single_scp == batch_scp);
+    for (int i = 0; i < count; ++i) {
+        mpz_class expected = (xs_plain[i] == ys_plain[i]) ? 2 : 0;
+        ok &= sk.decrypt_small(single[i].getCiphertext()) == expected;
+        ok &= sk.decrypt_small(batch[i].getCiphertext()) == expected;
+    }
+
+    PaillierPacker packer(pk, 8 + 2);
+    size_t packed_decryptions = packer.packed_count(2 * count) + packer.packed_count(count);
+    std::cout << "Slots per ciphertext:  " << packer.get_slots() << " x " << packer.get_slot_bits() << " bits" << std::endl;
+    std::cout << "Decryptions:           " << 3 * count << " -> " << packed_decryptions << std::endl;
+    std::cout << "Per-element SEP + SCP: " << single_ms << "ms" << std::endl;
+    std::cout << "Packed batch:          " << batch_ms << "ms (" << single_ms / batch_ms << "x)" << std::endl;
+    std::cout << "Results match:         " << (ok ? "Yes" : "No") << std::endl;
+    return ok;
+}
+
+// 同一组 SEP_MPSI/SCP 在 Paillier 与 EC-ElGamal 后端上的耗时和密文大小
+static bool bench_ec_backend(int key_bits, int count) {
+    std::cout << "\n--- EC-ElGamal backend benchmark (Paillier " << key_bits << " bits vs P-256, " << count
+              << " elements) ---" << std::endl;
+
+    PaillierKeyPair key_pair = PaillierKeyPair::generate(key_bits);
+    PaillierPublicKey pk = key_pair.get_public_key();
+    PaillierPrivateKey sk = key_pair.get_private_key();
+    ECElGamalPrivateKey ec_sk = ECElGamalPrivateKey::generate();
+    const ECElGamalPublicKey& ec_pk = ec_sk.get_public_key();
+
+    std::vector<EncryptedNumber> xs, ys;
+    std::vector<ECEncryptedNumber> ec_xs, ec_ys;
+    std::vector<int> xs_plain(count), ys_plain(count);
+    for (int i = 0; i < count; ++i) {
+        xs_plain[i] = i % 5;
+        ys_plain[i] = (i * 7) % 5;
+        xs.push_back(EncryptedNumber(sk.encrypt(xs_plain[i]), pk));
+        ys.push_back(EncryptedNumber(sk.encrypt(ys_plain[i]), pk));
+        ec_xs.push_back(ECEncryptedNumber(ec_pk.encrypt(xs_plain[i]), ec_pk));
+        ec_ys.push_back(ECEncryptedNumber(ec_pk.encrypt(ys_plain[i]), ec_pk));
+    }
+    mpz_class threshold = 3;
+    bool ok = true;
+
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < count; ++i) {
+        mpz_class expected = (xs_plain[i] == ys_plain[i]) ? 2 : 0;
+        ok &= sk.decrypt_small(SEP_MPSI(xs[i], ys[i], sk).getCiphertext()) == expected;
+        ok &= SCP(xs[i], threshold, sk) == ((xs_plain[i] < 3) ? -1 : 1);
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    double paillier_ms = std::chrono::duration<double, std::milli>(end - start).count();
+
+    start = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < count; ++i) {
+        mpz_class expected = (xs_plain[i] == ys_plain[i]) ? 2 : 0;
+        ok &= ec_sk.decrypt_small(SEP_MPSI(ec_xs[i], ec_ys[i], ec_sk).getCiphertext()) == expected;
+        ok &= SCP(ec_xs[i], threshold, ec_sk) == ((xs_plain[i] < 3) ? -1 : 1);
+    }
+    end = std::chrono::high_resolution_clock::now();
+    double ec_ms = std::chrono::duration<double, std::milli>(end - start).count();
+
+    // 单次同态加法
+    int rounds = 1000;
+    start = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < rounds; ++i) {
+        EncryptedNumber sum = xs[i % count] + ys[i % count];
+        ok &= sum.getCiphertext() != 0;
+    }
+    end = std::chrono::high_resolution_clock::now();
+    double paillier_add_us = std::chrono::duration<double, std::micro>(end - start).count() / rounds;
+
+    start = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < rounds; ++i) {
+        ECEncryptedNumber sum = ec_xs[i % count] + ec_ys[i % count];
+        ok &= !sum.getCiphertext().c1.is_infinity();
+    }
+    end = std::chrono::high_resolution_clock::now();
+    double ec_add_us = std::chrono::duration<double, std::micro>(end - start).count() / rounds;
+
+    std::cout << "Ciphertext size:       " << mpz_sizeinbase(pk.get_n_squared().get_mpz_t(), 256) << " -> "
+              << ec_xs[0].getCiphertext().serialized_size() << " bytes" << std::endl;
+    std::cout << "Homomorphic add:       " << paillier_add_us << "us -> " << ec_add_us << "us" << std::endl;
+    std::cout << "SEP_MPSI + SCP:        " << paillier_ms << "ms -> " << ec_ms << "ms (" << paillier_ms / ec_ms
+              << "x)" << std::endl;
+    std::cout << "Results match:         " << (ok ? "Yes" : "No") << std::endl;
+    return ok;
+}
+
+// 固定指数计划与 mpz_powm 的对比：r^n mod n^2（加密）和 c^(p-1) mod p^2（CRT 解密）
+static bool bench_fixed_exponent(int key_bits, int count) {
+    std::cout << "\n--- Fixed exponent plan benchmark (" << key_bits << " bits, " << count << " bases) ---" << std::endl;
+
+    PaillierKeyPair key_pair = PaillierKeyPair::generate(key_bits);
+    PaillierPublicKey pk = key_pair.get_public_key();
+    PaillierPrivateKey sk = key_pair.get_private_key();
+    mpz_class n = pk.get_n();
+    mpz_class n_squared = pk.get_n_squared();
+    mpz_class p = sk.get_p();
+    mpz_class p_squared = p * p;
+    mpz_class p_minus_1 = p - 1;
+    bool ok = true;
+
+    struct Case {
+        const char* label;
+        mpz_class modulus;
+        mpz_class exponent;
+    };
+    Case cases[2] = {{"r^n mod n^2", n_squared, n}, {"c^(p-1) mod p^2", p_squared, p_minus_1}};
+    for (const Case& c : cases) {
+        FixedExponentPlan plan(c.exponent);
+        MontgomeryContext ctx(c.modulus);
+        MultiBufferModExp modexp(c.modulus);
+        size_t bits = mpz_sizeinbase(c.exponent.get_mpz_t(), 2);
+
+        std::vector<mpz_class> bases(count), expected(count), single(count), batch(count);
+        for (int i = 0; i < count; ++i) {
+            bases[i] = PaillierUtil::random_r(c.modulus);
+        }
+
+        auto start = std::chrono::high_resolution_clock::now();
+        for (int i = 0; i < count; ++i) {
+            mpz_powm(expected[i].get_mpz_t(), bases[i].get_mpz_t(), c.exponent.get_mpz_t(), c.modulus.get_mpz_t());
+        }
+        auto end = std::chrono::high_resolution_clock::now();
+        double powm_us = std::chrono::duration<double, std::micro>(end - start).count() / count;
+
+        start = std::chrono::high_resolution_clock::now();
+        for (int i = 0; i < count; ++i) {
+            single[i] = plan.pow(ctx, bases[i]);
+        }
+        end = std::chrono::high_resolution_clock::now();
+        double plan_us = std::chrono::duration<double, std::micro>(end - start).count() / count;
+
+        start = std::chrono::high_resolution_clock::now();
+        modexp.pow(bases.data(), count, plan, batch.data());
+        end = std::chrono::high_resolution_clock::now();
+        double batch_us = std::chrono::duration<double, std::micro>(end - start).count() / count;
+
+        ok &= (single == expected) && (batch == expected);
+        std::cout << c.label << ": window " << plan.get_window_bits() << ", " << plan.multiplications()
+                  << " mul + " << plan.squarings() << " sqr (4-bit fixed window: " << (bits + 3) / 4 + 14
+                  << " mul)" << std::endl;
+        std::cout << "  mpz_powm:                  " << powm_us << "us/op" << std::endl;
+        std::cout << "  plan (Montgomery):         " << plan_us << "us/op (" << powm_us / plan_us << "x)" << std::endl;
+        std::cout << "  plan (" << MultiBufferModExp::backend_name(modexp.get_backend()) << " multi-buffer): "
+                  << batch_us << "us/op (" << powm_us / batch_us << "x)" << std::endl;
+    }
+    std::cout << "Results match:         " << (ok ? "Yes" : "No") << std::endl;
+    return ok;
+}
+
+int main() {
+    try {
+        bool ok = true;
+        ok &= bench_decrypt(1024, 200);
+        ok &= bench_decrypt(2048, 50);
+        ok &= bench_private_encrypt(2048, 50);
+        ok &= bench_random_pool(2048, 64);
+        ok &= bench_batch(2048, 64);
+        ok &= bench_multi_buffer(1024, 64);
+        ok &= bench_multi_buffer(2048, 32);
+        ok &= bench_fixed_exponent(2048, 32);
+        ok &= bench_fixed_base(1024, 100);
+        ok &= bench_fixed_base(2048, 50);
+        ok &= bench_fixed_base(3072, 20);
+        ok &= bench_key_store(2048);
+        ok &= bench_montgomery(1024, 64, 200);
+        ok &= bench_montgomery(2048, 64, 100);
+        ok &= bench_sep_expression(1024, 200);
+        ok &= bench_sep_expression(2048, 50);
+        ok &= bench_packing(2048, 64);
+        ok &= bench_ec_backend(2048, 64);
+        ok &= bench_keygen(1024, 20);
+        ok &= bench_keygen(2048, 10);
+        return ok ? 0 : 1;
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+}
@@ -4,8 +4,8 @@
 
 int main() {
     try {
-        std::cout << "Generating Paillier key pair (2048 bits)..." << std::endl;
-        PaillierKeyPair key_pair = PaillierKeyPair::generate(2048);
+        std::cout << "Loading Paillier key pair (2048 bits)..." << std::endl;
+        PaillierKeyPair key_pair = PaillierKeyPair::load_or_generate("paillier_2048.key", 2048);
         
         PaillierPublicKey public_key = key_pair.get_public_key();
         PaillierPrivateKey private_key = key_pair.get_private_key();
@@ -1,70 +1,47 @@
 #include "seq.h"
+#include "PaillierPacking.h"
+#include "SecureRandom.h"
 #include <stdexcept>
-#include <random>
-
-// EncryptedNumber 实现
-EncryptedNumber::EncryptedNumber(const mpz_class& ct, const PaillierPublicKey& pk)
-    : ciphertext(ct), public_key(&pk) {}
-
-EncryptedNumber EncryptedNumber::operator+(const EncryptedNumber& other) const {
-    if (public_key != other.public_key) {
-        throw std::runtime_error("Cannot add ciphertexts with different public keys");
-    }
-    mpz_class result = PaillierHomomorphic::add(*public_key, ciphertext, other.ciphertext);
-    return EncryptedNumber(result, *public_key);
-}
-
-EncryptedNumber EncryptedNumber::operator*(const mpz_class& scalar) const {
-    mpz_class result = PaillierHomomorphic::multiply_scalar(*public_key, ciphertext, scalar);
-    return EncryptedNumber(result, *public_key);
-}
-
-EncryptedNumber EncryptedNumber::operator-() const {
-    mpz_class neg_one = -1;
-    return *this * neg_one;
-}
 
 // SEP_TMPSI 实现
-EncryptedNumber SEP_TMPSI(const EncryptedNumber& x, const EncryptedNumber& y,
-                         const PaillierPrivateKey& sk) {
-    if (x.getPublicKey().get_n() != y.getPublicKey().get_n()) {
+template <class Scheme>
+EncryptedValue<Scheme> SEP_TMPSI(const EncryptedValue<Scheme>& x, const EncryptedValue<Scheme>& y,
+                                 const typename Scheme::PrivateKey& sk) {
+    typedef EncryptedValue<Scheme> EncryptedNumber;
+    if (!Scheme::same_key(x.getPublicKey(), y.getPublicKey())) {
         throw std::runtime_error("Input ciphertexts must use same public key");
     }
 
-    const PaillierPublicKey& pk = x.getPublicKey();
+    const typename Scheme::PublicKey& pk = x.getPublicKey();
     mpz_class one = 1;
-    EncryptedNumber enc_one = EncryptedNumber(pk.encrypt(one), pk);
+    EncryptedNumber enc_one = EncryptedNumber(sk.encrypt(one), pk);
 
     // 如果 x == y，直接返回 2 * enc_one
     EncryptedNumber diff = x + (-y);
-    mpz_class diff_dec = sk.decrypt(diff.getCiphertext());
-    if (diff_dec == 0) {
+    if (Scheme::is_zero(sk, diff.getCiphertext())) {
         return enc_one * 2; // 返回 2 表示相等
     }
 
-    std::random_device rd;
-    std::mt19937 gen(rd());
-    std::uniform_int_distribution<> dis(0, 1);
-    int s1 = dis(gen) ? 1 : -1;
-    int s2 = dis(gen) ? 1 : -1;
+    int s1 = SecureRandom::random_sign();
+    int s2 = SecureRandom::random_sign();
 
     mpz_class r1 = 2, r3 = 2;
     EncryptedNumber y_neg = -y;
     EncryptedNumber x_neg = -x;
 
     // a = ((x - y) * r1) * s1 + (-1 * s1)
-    EncryptedNumber a = ((x + y_neg) * r1) * s1 + (EncryptedNumber(pk.encrypt(-s1), pk));
+    EncryptedNumber a = ((x + y_neg) * r1) * s1 + (EncryptedNumber(sk.encrypt(-s1), pk));
     
     // b = ((y - x) * r3) * s2 + (-1 * s2)
-    EncryptedNumber b = ((y + x_neg) * r3) * s2 + (EncryptedNumber(pk.encrypt(-s2), pk));
+    EncryptedNumber b = ((y + x_neg) * r3) * s2 + (EncryptedNumber(sk.encrypt(-s2), pk));
 
-    // 解密中间结果
-    mpz_class a_dec = sk.decrypt(a.getCiphertext());
-    mpz_class b_dec = sk.decrypt(b.getCiphertext());
+    // 解密中间结果（a、b 的明文很小，只需判断符号）
+    mpz_class a_dec = sk.decrypt_small(a.getCiphertext());
+    mpz_class b_dec = sk.decrypt_small(b.getCiphertext());
 
     // 根据解密结果选择返回1或-1
-    EncryptedNumber c = (a_dec > 0) ? EncryptedNumber(pk.encrypt(-s1), pk) : EncryptedNumber(pk.encrypt(s1), pk);
-    EncryptedNumber d = (b_dec > 0) ? EncryptedNumber(pk.encrypt(-s2), pk) : EncryptedNumber(pk.encrypt(s2), pk);
+    EncryptedNumber c = (a_dec > 0) ? EncryptedNumber(sk.encrypt(-s1), pk) : EncryptedNumber(sk.encrypt(s1), pk);
+    EncryptedNumber d = (b_dec > 0) ? EncryptedNumber(sk.encrypt(-s2), pk) : EncryptedNumber(sk.encrypt(s2), pk);
 
     return c + d;
 }
@@ -72,37 +49,36 @@ EncryptedNumber SEP_TMPSI(const EncryptedNumber& x, const EncryptedNumber& y,
 
 
 // SEP_MPSI 实现 
-EncryptedNumber SEP_MPSI(const EncryptedNumber& x, const EncryptedNumber& y,
-                        const PaillierPrivateKey& sk) {
-    if (x.getPublicKey().get_n() != y.getPublicKey().get_n()) {
+template <class Scheme>
+EncryptedValue<Scheme> SEP_MPSI(const EncryptedValue<Scheme>& x, const EncryptedValue<Scheme>& y,
+                                const typename Scheme::PrivateKey& sk) {
+    typedef EncryptedValue<Scheme> EncryptedNumber;
+    if (!Scheme::same_key(x.getPublicKey(), y.getPublicKey())) {
         throw std::runtime_error("Input ciphertexts must use same public key");
     }
 
-    const PaillierPublicKey& pk = x.getPublicKey();
+    const typename Scheme::PublicKey& pk = x.getPublicKey();
     mpz_class one = 1;
-    EncryptedNumber enc_one = EncryptedNumber(pk.encrypt(one), pk);
+    EncryptedNumber enc_one = EncryptedNumber(sk.encrypt(one), pk);
     EncryptedNumber enc_one_neg = enc_one * (-1);
 
     // 随机选择 s1 和 s2
-    std::random_device rd;
-    std::mt19937 gen(rd());
-    std::uniform_int_distribution<> dis(0, 1);
-    int s1 = dis(gen) ? 1 : -1;
-    int s2 = dis(gen) ? 1 : -1;
+    int s1 = SecureRandom::random_sign();
+    int s2 = SecureRandom::random_sign();
 
     mpz_class r1 = 2, r3 = 2;
     EncryptedNumber y_neg = y * (-1);
     EncryptedNumber x_neg = x * (-1);
 
     // 计算 a = ((x - y) * r1) * s1 + (-1 * s1)
-    EncryptedNumber a = ((x + y_neg) * r1) * s1 + (EncryptedNumber(pk.encrypt(-s1), pk));
+    EncryptedNumber a = ((x + y_neg) * r1) * s1 + (EncryptedNumber(sk.encrypt(-s1), pk));
     
     // 计算 b = ((y - x) * r3) * s2 + (-1 * s2)
-    EncryptedNumber b = ((y + x_neg) * r3) * s2 + (EncryptedNumber(pk.encrypt(-s2), pk));
+    EncryptedNumber b = ((y + x_neg) * r3) * s2 + (EncryptedNumber(sk.encrypt(-s2), pk));
 
-    // 解密 a 和 b
-    mpz_class a_dec = sk.decrypt(a.getCiphertext());
-    mpz_class b_dec = sk.decrypt(b.getCiphertext());
+    // 解密 a 和 b（明文很小，只需判断符号）
+    mpz_class a_dec = sk.decrypt_small(a.getCiphertext());
+    mpz_class b_dec = sk.decrypt_small(b.getCiphertext());
 
     // 根据解密结果选择 c 和 d
     EncryptedNumber c = (a_dec > 0) ? enc_one_neg : enc_one;
@@ -118,17 +94,16 @@ EncryptedNumber SEP_MPSI(const EncryptedNumber& x, const EncryptedNumber& y,
 
 
 // SCP 函数实现
-mpz_class SCP(const EncryptedNumber& x, const mpz_class& threshold,
-             const PaillierPrivateKey& sk) {
-    const PaillierPublicKey& pk = x.getPublicKey();
+template <class Scheme>
+mpz_class SCP(const EncryptedValue<Scheme>& x, const mpz_class& threshold,
+              const typename Scheme::PrivateKey& sk) {
+    typedef EncryptedValue<Scheme> EncryptedNumber;
+    const typename Scheme::PublicKey& pk = x.getPublicKey();
     mpz_class one = 1;
-    EncryptedNumber enc_threshold = EncryptedNumber(pk.encrypt(threshold), pk);
+    EncryptedNumber enc_threshold = EncryptedNumber(sk.encrypt(threshold), pk);
     EncryptedNumber x_neg = -x;
 
-    std::random_device rd;
-    std::mt19937 gen(rd());
-    std::uniform_int_distribution<> dis(0, 1);
-    int s3 = dis(gen) ? 1 : -1;
+    int s3 = SecureRandom::random_sign();
 
     mpz_class r3 = 2;
     mpz_class s3_mpz(s3);
@@ -141,14 +116,158 @@ mpz_class SCP(const EncryptedNumber& x, const mpz_class& threshold,
     temp = temp * s3_mpz;
     
     // 最后加上 (-1 * s3) 的加密值
-    EncryptedNumber enc_neg_s3 = EncryptedNumber(pk.encrypt(neg_one_mpz * s3_mpz), pk);
+    EncryptedNumber enc_neg_s3 = EncryptedNumber(sk.encrypt(neg_one_mpz * s3_mpz), pk);
     EncryptedNumber f = temp + enc_neg_s3;
 
-    mpz_class f_dec = sk.decrypt(f.getCiphertext());
+    mpz_class f_dec = sk.decrypt_small(f.getCiphertext());
     mpz_class g = (f_dec <= 0) ? one : -one;
     g = (s3 == -1) ? -g : g;
 
     return g;
 }
 
+// 两种后端的显式实例化
+template EncryptedNumber SEP_TMPSI<PaillierScheme>(const EncryptedNumber&, const EncryptedNumber&,
+                                                   const PaillierPrivateKey&);
+template EncryptedNumber SEP_MPSI<PaillierScheme>(const EncryptedNumber&, const EncryptedNumber&,
+                                                  const PaillierPrivateKey&);
+template mpz_class SCP<PaillierScheme>(const EncryptedNumber&, const mpz_class&, const PaillierPrivateKey&);
+template ECEncryptedNumber SEP_TMPSI<ECElGamalScheme>(const ECEncryptedNumber&, const ECEncryptedNumber&,
+                                                      const ECElGamalPrivateKey&);
+template ECEncryptedNumber SEP_MPSI<ECElGamalScheme>(const ECEncryptedNumber&, const ECEncryptedNumber&,
+                                                     const ECElGamalPrivateKey&);
+template mpz_class SCP<ECElGamalScheme>(const ECEncryptedNumber&, const mpz_class&, const ECElGamalPrivateKey&);
+
+
+// 批量版本：盲化后的比较值按槽打包，持有私钥一方每个打包密文只解密一次
+namespace {
+
+void check_batch_inputs(const std::vector<EncryptedNumber>& values, size_t expected, const PaillierPublicKey& pk) {
+    if (values.size() != expected) {
+        throw std::runtime_error("Batch inputs must have the same length");
+    }
+    for (const auto& value : values) {
+        if (value.getPublicKey().get_n() != pk.get_n()) {
+            throw std::runtime_error("Input ciphertexts must use same public key");
+        }
+    }
+}
+
+// 打包、解密、拆槽
+std::vector<mpz_class> decrypt_packed(const std::vector<mpz_class>& ciphertexts, const PaillierPublicKey& pk,
+                                      const PaillierPrivateKey& sk, int value_bits) {
+    PaillierPacker packer(pk, value_bits);
+    std::vector<mpz_class> packed = packer.pack(ciphertexts.data(), ciphertexts.size());
+    std::vector<mpz_class> plain(ciphertexts.size());
+    packer.unpack(sk, packed, ciphertexts.size(), plain.data());
+    return plain;
+}
+
+}
+
+std::vector<EncryptedNumber> SEP_TMPSI_batch(const std::vector<EncryptedNumber>& xs,
+                                             const std::vector<EncryptedNumber>& ys,
+                                             const PaillierPrivateKey& sk, int value_bits) {
+    if (xs.empty()) {
+        return {};
+    }
+    const PaillierPublicKey& pk = xs[0].getPublicKey();
+    check_batch_inputs(xs, xs.size(), pk);
+    check_batch_inputs(ys, xs.size(), pk);
+    size_t count = xs.size();
+    mpz_class r1 = 2, r3 = 2;
+
+    // 每个元素占三个槽：x - y、a、b；|a|、|b| <= 2|x - y| + 1
+    std::vector<int> s1(count), s2(count);
+    std::vector<mpz_class> blinded(3 * count);
+    for (size_t i = 0; i < count; i++) {
+        const EncryptedNumber& x = xs[i];
+        const EncryptedNumber& y = ys[i];
+        s1[i] = SecureRandom::random_sign();
+        s2[i] = SecureRandom::random_sign();
+        blinded[3 * i] = EncryptedNumber(x + (-y)).getCiphertext();
+        blinded[3 * i + 1] = EncryptedNumber(((x + (-y)) * r1) * s1[i] + EncryptedNumber(sk.encrypt(-s1[i]), pk)).getCiphertext();
+        blinded[3 * i + 2] = EncryptedNumber(((y + (-x)) * r3) * s2[i] + EncryptedNumber(sk.encrypt(-s2[i]), pk)).getCiphertext();
+    }
+    std::vector<mpz_class> plain = decrypt_packed(blinded, pk, sk, value_bits + 2);
+
+    std::vector<EncryptedNumber> result;
+    result.reserve(count);
+    for (size_t i = 0; i < count; i++) {
+        if (plain[3 * i] == 0) {
+            result.push_back(EncryptedNumber(sk.encrypt(2), pk)); // 返回 2 表示相等
+            continue;
+        }
+        EncryptedNumber c = (plain[3 * i + 1] > 0) ? EncryptedNumber(sk.encrypt(-s1[i]), pk) : EncryptedNumber(sk.encrypt(s1[i]), pk);
+        EncryptedNumber d = (plain[3 * i + 2] > 0) ? EncryptedNumber(sk.encrypt(-s2[i]), pk) : EncryptedNumber(sk.encrypt(s2[i]), pk);
+        result.push_back(c + d);
+    }
+    return result;
+}
+
+std::vector<EncryptedNumber> SEP_MPSI_batch(const std::vector<EncryptedNumber>& xs,
+                                            const std::vector<EncryptedNumber>& ys,
+                                            const PaillierPrivateKey& sk, int value_bits) {
+    if (xs.empty()) {
+        return {};
+    }
+    const PaillierPublicKey& pk = xs[0].getPublicKey();
+    check_batch_inputs(xs, xs.size(), pk);
+    check_batch_inputs(ys, xs.size(), pk);
+    size_t count = xs.size();
+    mpz_class r1 = 2, r3 = 2;
+
+    // 每个元素占两个槽：a、b
+    std::vector<int> s1(count), s2(count);
+    std::vector<mpz_class> blinded(2 * count);
+    for (size_t i = 0; i < count; i++) {
+        const EncryptedNumber& x = xs[i];
+        const EncryptedNumber& y = ys[i];
+        s1[i] = SecureRandom::random_sign();
+        s2[i] = SecureRandom::random_sign();
+        blinded[2 * i] = EncryptedNumber(((x + (-y)) * r1) * s1[i] + EncryptedNumber(sk.encrypt(-s1[i]), pk)).getCiphertext();
+        blinded[2 * i + 1] = EncryptedNumber(((y + (-x)) * r3) * s2[i] + EncryptedNumber(sk.encrypt(-s2[i]), pk)).getCiphertext();
+    }
+    std::vector<mpz_class> plain = decrypt_packed(blinded, pk, sk, value_bits + 2);
+
+    std::vector<EncryptedNumber> result;
+    result.reserve(count);
+    for (size_t i = 0; i < count; i++) {
+        EncryptedNumber enc_one = EncryptedNumber(sk.encrypt(1), pk);
+        EncryptedNumber enc_one_neg = enc_one * (-1);
+        EncryptedNumber c = (plain[2 * i] > 0) ? enc_one_neg : enc_one;
+        EncryptedNumber d = (plain[2 * i + 1] > 0) ? enc_one_neg : enc_one;
+        c = (s1[i] == -1) ? c * (-1) : c;
+        d = (s2[i] == -1) ? d * (-1) : d;
+        result.push_back(c + d);
+    }
+    return result;
+}
+
+std::vector<mpz_class> SCP_batch(const std::vector<EncryptedNumber>& xs, const mpz_class& threshold,
+                                 const PaillierPrivateKey& sk, int value_bits) {
+    if (xs.empty()) {
+        return {};
+    }
+    const PaillierPublicKey& pk = xs[0].getPublicKey();
+    check_batch_inputs(xs, xs.size(), pk);
+    size_t count = xs.size();
+    mpz_class r3 = 2;
 
+    std::vector<int> s3(count);
+    std::vector<mpz_class> blinded(count);
+    for (size_t i = 0; i < count; i++) {
+        s3[i] = SecureRandom::random_sign();
+        EncryptedNumber enc_threshold = EncryptedNumber(sk.encrypt(threshold), pk);
+        blinded[i] = EncryptedNumber(((enc_threshold + (-xs[i])) * r3) * s3[i] +
+                                     EncryptedNumber(sk.encrypt(-s3[i]), pk)).getCiphertext();
+    }
+    std::vector<mpz_class> plain = decrypt_packed(blinded, pk, sk, value_bits + 2);
+
+    std::vector<mpz_class> result(count);
+    for (size_t i = 0; i < count; i++) {
+        mpz_class g = (plain[i] <= 0) ? 1 : -1;
+        result[i] = (s3[i] == -1) ? -g : g;
+    }
+    return result;
+}
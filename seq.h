@@ -1,34 +1,195 @@
 #ifndef SEQ_H
 #define SEQ_H
 
-#include "PaillierCrypto.h"
-#include <random>
+#include "AdditiveHE.h"
+#include <array>
+#include <cstddef>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
 
-class EncryptedNumber {
+// 密文表达式的公共基类标记：+、*、- 只构造惰性表达式树，
+// 赋值给 EncryptedValue 时整棵树被展开成 sum s_k * c_k，由 Scheme::linear_combination 一次求值
+// 表达式只引用操作数，不要用 auto 保存到下一条语句之后
+struct EncryptedExpr {};
+
+// 加法同态密文，Scheme 见 AdditiveHE.h
+template <class Scheme>
+class EncryptedValue {
 private:
-    mpz_class ciphertext;
-    const PaillierPublicKey* public_key; // 使用指针避免拷贝
+    typename Scheme::Ciphertext ciphertext;
+    const typename Scheme::PublicKey* public_key; // 使用指针避免拷贝
 
 public:
-    EncryptedNumber(const mpz_class& ct, const PaillierPublicKey& pk);
-    
+    typedef Scheme scheme;
+
+    EncryptedValue(const typename Scheme::Ciphertext& ct, const typename Scheme::PublicKey& pk)
+        : ciphertext(ct), public_key(&pk) {}
+
+    // 对表达式求值
+    template <class Expr, typename std::enable_if<std::is_base_of<EncryptedExpr, Expr>::value &&
+                                                      std::is_same<typename Expr::scheme, Scheme>::value,
+                                                  int>::type = 0>
+    EncryptedValue(const Expr& expr);
+
     // 获取加密值和公钥
-    const mpz_class& getCiphertext() const { return ciphertext; }
-    const PaillierPublicKey& getPublicKey() const { return *public_key; }
+    const typename Scheme::Ciphertext& getCiphertext() const { return ciphertext; }
+    const typename Scheme::PublicKey& getPublicKey() const { return *public_key; }
+};
 
-    // 运算符重载
-    EncryptedNumber operator+(const EncryptedNumber& other) const;
-    EncryptedNumber operator*(const mpz_class& scalar) const;
-    EncryptedNumber operator-() const;
+typedef EncryptedValue<PaillierScheme> EncryptedNumber;
+typedef EncryptedValue<ECElGamalScheme> ECEncryptedNumber;
+
+namespace seq_detail {
+
+// 表达式展开后的项：密文指针与累积的标量
+template <class Scheme, size_t N>
+struct ExprTerms {
+    std::array<const typename Scheme::Ciphertext*, N> ciphertexts;
+    std::array<mpz_class, N> scalars;
+    const typename Scheme::PublicKey* public_key = nullptr;
+    size_t count = 0;
+
+    void add(const EncryptedValue<Scheme>& value, const mpz_class& scalar) {
+        if (public_key == nullptr) {
+            public_key = &value.getPublicKey();
+        } else if (public_key != &value.getPublicKey()) {
+            throw std::runtime_error("Cannot add ciphertexts with different public keys");
+        }
+        ciphertexts[count] = &value.getCiphertext();
+        scalars[count] = scalar;
+        count++;
+    }
 };
 
-// 安全比较协议函数
-EncryptedNumber SEP_TMPSI(const EncryptedNumber& x, const EncryptedNumber& y,
-                         const PaillierPrivateKey& sk);
-EncryptedNumber SEP_MPSI(const EncryptedNumber& x, const EncryptedNumber& y,
-                        const PaillierPrivateKey& sk);
-mpz_class SCP(const EncryptedNumber& x, const mpz_class& threshold,
-             const PaillierPrivateKey& sk);
+// 叶子：引用一个已求值的密文
+template <class Scheme>
+struct Leaf : EncryptedExpr {
+    typedef Scheme scheme;
+    static constexpr size_t size = 1;
+    const EncryptedValue<Scheme>& value;
 
-#endif // SEQ_H
+    explicit Leaf(const EncryptedValue<Scheme>& value) : value(value) {}
 
+    template <size_t N>
+    void collect(ExprTerms<Scheme, N>& terms, const mpz_class& scalar) const {
+        terms.add(value, scalar);
+    }
+};
+
+// 同态加法
+template <class L, class R>
+struct Sum : EncryptedExpr {
+    static_assert(std::is_same<typename L::scheme, typename R::scheme>::value,
+                  "Cannot add ciphertexts of different schemes");
+    typedef typename L::scheme scheme;
+    static constexpr size_t size = L::size + R::size;
+    L left;
+    R right;
+
+    Sum(const L& left, const R& right) : left(left), right(right) {}
+
+    template <size_t N>
+    void collect(ExprTerms<scheme, N>& terms, const mpz_class& scalar) const {
+        left.collect(terms, scalar);
+        right.collect(terms, scalar);
+    }
+};
+
+// 标量乘法，取负即乘以 -1；嵌套的标量在展开时相乘
+template <class E>
+struct Scaled : EncryptedExpr {
+    typedef typename E::scheme scheme;
+    static constexpr size_t size = E::size;
+    E inner;
+    mpz_class scalar;
+
+    Scaled(const E& inner, const mpz_class& scalar) : inner(inner), scalar(scalar) {}
+
+    template <size_t N>
+    void collect(ExprTerms<scheme, N>& terms, const mpz_class& outer) const {
+        inner.collect(terms, outer * scalar);
+    }
+};
+
+// 操作数到表达式节点的映射：EncryptedValue 包成叶子，表达式按值保存
+template <class T, class Enable = void>
+struct Node;
+
+template <class Scheme>
+struct Node<EncryptedValue<Scheme>> {
+    typedef Leaf<Scheme> type;
+    static Leaf<Scheme> make(const EncryptedValue<Scheme>& value) { return Leaf<Scheme>(value); }
+};
+
+template <class T>
+struct Node<T, typename std::enable_if<std::is_base_of<EncryptedExpr, T>::value>::type> {
+    typedef T type;
+    static const T& make(const T& expr) { return expr; }
+};
+
+template <class T>
+struct IsEncryptedValue : std::false_type {};
+
+template <class Scheme>
+struct IsEncryptedValue<EncryptedValue<Scheme>> : std::true_type {};
+
+template <class T>
+struct IsOperand
+    : std::integral_constant<bool, IsEncryptedValue<T>::value || std::is_base_of<EncryptedExpr, T>::value> {};
+
+}
+
+template <class Scheme>
+template <class Expr, typename std::enable_if<std::is_base_of<EncryptedExpr, Expr>::value &&
+                                                  std::is_same<typename Expr::scheme, Scheme>::value,
+                                              int>::type>
+EncryptedValue<Scheme>::EncryptedValue(const Expr& expr) {
+    seq_detail::ExprTerms<Scheme, Expr::size> terms;
+    expr.collect(terms, mpz_class(1));
+    public_key = terms.public_key;
+    ciphertext = Scheme::linear_combination(*public_key, terms.ciphertexts.data(), terms.scalars.data(), terms.count);
+}
+
+// 运算符重载：构造表达式，不立即计算
+template <class L, class R,
+          typename std::enable_if<seq_detail::IsOperand<L>::value && seq_detail::IsOperand<R>::value, int>::type = 0>
+seq_detail::Sum<typename seq_detail::Node<L>::type, typename seq_detail::Node<R>::type>
+operator+(const L& left, const R& right) {
+    return seq_detail::Sum<typename seq_detail::Node<L>::type, typename seq_detail::Node<R>::type>(
+        seq_detail::Node<L>::make(left), seq_detail::Node<R>::make(right));
+}
+
+template <class E, typename std::enable_if<seq_detail::IsOperand<E>::value, int>::type = 0>
+seq_detail::Scaled<typename seq_detail::Node<E>::type> operator*(const E& expr, const mpz_class& scalar) {
+    return seq_detail::Scaled<typename seq_detail::Node<E>::type>(seq_detail::Node<E>::make(expr), scalar);
+}
+
+template <class E, typename std::enable_if<seq_detail::IsOperand<E>::value, int>::type = 0>
+seq_detail::Scaled<typename seq_detail::Node<E>::type> operator-(const E& expr) {
+    return seq_detail::Scaled<typename seq_detail::Node<E>::type>(seq_detail::Node<E>::make(expr), -1);
+}
+
+// 安全比较协议函数，对 Paillier 和 EC-ElGamal 后端均已实例化
+template <class Scheme>
+EncryptedValue<Scheme> SEP_TMPSI(const EncryptedValue<Scheme>& x, const EncryptedValue<Scheme>& y,
+                                 const typename Scheme::PrivateKey& sk);
+template <class Scheme>
+EncryptedValue<Scheme> SEP_MPSI(const EncryptedValue<Scheme>& x, const EncryptedValue<Scheme>& y,
+                                const typename Scheme::PrivateKey& sk);
+template <class Scheme>
+mpz_class SCP(const EncryptedValue<Scheme>& x, const mpz_class& threshold,
+              const typename Scheme::PrivateKey& sk);
+
+// 批量版本（仅 Paillier）：所有元素的盲化比较值打包进少量密文，每个打包密文只解密一次
+// 要求每个元素 |x - y|（SCP 为 |threshold - x|）< 2^value_bits，否则会破坏同一密文中其他元素的结果
+std::vector<EncryptedNumber> SEP_TMPSI_batch(const std::vector<EncryptedNumber>& xs,
+                                             const std::vector<EncryptedNumber>& ys,
+                                             const PaillierPrivateKey& sk, int value_bits = 32);
+std::vector<EncryptedNumber> SEP_MPSI_batch(const std::vector<EncryptedNumber>& xs,
+                                            const std::vector<EncryptedNumber>& ys,
+                                            const PaillierPrivateKey& sk, int value_bits = 32);
+std::vector<mpz_class> SCP_batch(const std::vector<EncryptedNumber>& xs, const mpz_class& threshold,
+                                 const PaillierPrivateKey& sk, int value_bits = 32);
+
+#endif // SEQ_H
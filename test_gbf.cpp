@@ -1,5 +1,9 @@
 #include "PaillierCrypto.h"
 #include "GarbledBloom.h"
+#include "GarbledBloomStore.h"
+#include "SecureRandom.h"
+#include <algorithm>
+#include <cstdio>
 #include <iostream>
 #include <vector>
 #include <string>
@@ -46,7 +50,201 @@ int main() {
         std::cout << "Element: " << nonExistingElement << std::endl;
         std::cout << "Decrypted value: " << decrypted << std::endl;
         std::cout << "Is in set: " << (decrypted == 1 ? "Yes" : "No") << std::endl;
-        
+
+        // Legacy 位置：与旧版本（十种摘要的十六进制按 8 位分段 stoull 异或后对 m 取模）的已知结果一致
+        std::cout << "检查 Legacy 位置..." << std::endl;
+        struct LegacyCase {
+            int n;  // m = 10n / 0.69
+            const char* element;
+            size_t positions[GarbledBloomFilter::NUM_HASHES];
+        };
+        const LegacyCase legacyCases[] = {
+            {1, "apple", {2, 13, 5, 2, 8, 5, 11, 11, 8, 12}},
+            {1, "dup0", {4, 12, 8, 1, 8, 11, 4, 12, 9, 1}},
+            {100, "11", {1000, 937, 1085, 115, 172, 562, 342, 320, 464, 1348}},
+            {10000, "psi-element-42", {47581, 135789, 59627, 109901, 71241, 130122, 76280, 135597, 13223, 125429}},
+            {100000, "apple", {768008, 1085488, 822306, 925865, 1045002, 1420436, 1087228, 589066, 1268905, 590063}},
+        };
+        for (const auto& c : legacyCases) {
+            GarbledBloomFilter128 legacy(c.n, GBFHashScheme::Legacy);
+            size_t single[GarbledBloomFilter::NUM_HASHES];
+            legacy.computePositions(c.element, single);
+            std::vector<size_t> batch = legacy.computePositionsBatch(std::vector<std::string>{c.element});
+            if (!std::equal(single, single + GarbledBloomFilter::NUM_HASHES, c.positions) ||
+                !std::equal(batch.begin(), batch.end(), c.positions)) {
+                std::cout << "Legacy positions mismatch: " << c.element << " (n = " << c.n << ")" << std::endl;
+                return 1;
+            }
+        }
+        std::cout << "Legacy positions match: Yes" << std::endl;
+
+        // Legacy 位置重复：dup0 的预留槽位 4 再次出现，它应按种子展开值参与最终 share，
+        // 即最终 share = payload 与空 filter 中其余 9 个位置的行的异或，且不能等于查询结果
+        {
+            const std::vector<std::string> dup = {"dup0"};
+            GarbledBloomFilter128 expected(1, GBFHashScheme::Legacy);
+            GarbledBloomFilter128 built = expected;
+            unsigned char seed[GarbledBloomFilter128::SEED_SIZE];
+            SecureRandom::fill_bytes(seed, sizeof(seed));
+            uint64_t payload[GarbledBloomFilter128::ROW_LIMBS];
+            for (auto& limb : payload) {
+                limb = SecureRandom::next_u64();
+            }
+            expected.generate(std::vector<std::string>(), payload, seed);
+            built.generate(dup, payload, seed);
+
+            GBFView before = expected.getFilter();
+            std::vector<uint64_t> share(payload, payload + GarbledBloomFilter128::ROW_LIMBS);
+            for (int i = 1; i < GarbledBloomFilter::NUM_HASHES; i++) {
+                const uint64_t* line = before.row(legacyCases[1].positions[i]);
+                for (size_t c = 0; c < share.size(); c++) {
+                    share[c] ^= line[c];
+                }
+            }
+            size_t reserved = legacyCases[1].positions[0];
+            GBFView after = built.getFilter();
+            bool same = true;
+            for (size_t j = 0; j < after.size(); j++) {
+                const uint64_t* want = j == reserved ? share.data() : before.row(j);
+                same &= std::equal(want, want + GarbledBloomFilter128::ROW_LIMBS, after.row(j));
+            }
+            uint64_t result[GarbledBloomFilter128::ROW_LIMBS];
+            built.query("dup0", result);
+            same &= !std::equal(result, result + GarbledBloomFilter128::ROW_LIMBS, after.row(reserved));
+            std::cout << "Legacy duplicate reserved slot: " << (same ? "Yes" : "No") << std::endl;
+            if (!same) {
+                return 1;
+            }
+        }
+
+        // SHA256 位置哈希：k 个位置互不相同，集合内元素都能还原出 payload 密文
+        std::cout << "检查 SHA256 位置哈希..." << std::endl;
+        std::vector<std::string> members = {"apple", "banana", "cherry", "date", "elderberry", "11", "22"};
+        GarbledBloomFilter filter(members.size(), public_key, GBFHashScheme::SHA256);
+        filter.generate(members, 1);
+        for (const auto& element : members) {
+            if (private_key.decrypt(filter.query(element)) != 1) {
+                std::cout << "Member lost: " << element << std::endl;
+                return 1;
+            }
+        }
+        std::cout << "All members recovered: Yes" << std::endl;
+
+        // 批量查询与逐个查询一致（含不在集合中的元素）
+        std::vector<std::string> probes = members;
+        probes.push_back("fig");
+        std::vector<mpz_class> batch = filter.queryBatch(probes);
+        for (size_t e = 0; e < probes.size(); e++) {
+            if (batch[e] != filter.query(probes[e])) {
+                std::cout << "Batch query mismatch: " << probes[e] << std::endl;
+                return 1;
+            }
+        }
+        std::cout << "Batch query matches: Yes" << std::endl;
+
+        // getFilter() 视图：按行异或 k 个槽位应与 query 结果一致
+        GBFView view = filter.getFilter();
+        size_t positions[GarbledBloomFilter::MAX_HASHES];
+        filter.computePositions("banana", positions);
+        mpz_class recovered = 0;
+        for (int i = 0; i < filter.getNumHashes(); i++) {
+            recovered ^= view.slot(positions[i]);
+        }
+        std::cout << "View matches query: " << (recovered == filter.query("banana") ? "Yes" : "No") << std::endl;
+        if (recovered != filter.query("banana")) {
+            return 1;
+        }
+
+        // 编译期行宽：128 位明文 payload，以及 2048 位行存放密文
+        std::cout << "检查定宽 share..." << std::endl;
+        GarbledBloomFilter128 keys(members.size());
+        std::vector<uint64_t> payloads(members.size() * GarbledBloomFilter128::ROW_LIMBS);
+        for (auto& limb : payloads) {
+            limb = SecureRandom::next_u64();
+        }
+        keys.generate(members, payloads.data());
+        GarbledBloomFilter2048 wide(members.size(), public_key);
+        wide.generate(members, 1);
+        for (size_t e = 0; e < members.size(); e++) {
+            uint64_t key[GarbledBloomFilter128::ROW_LIMBS];
+            keys.query(members[e], key);
+            const uint64_t* expected = &payloads[e * GarbledBloomFilter128::ROW_LIMBS];
+            if (!std::equal(key, key + GarbledBloomFilter128::ROW_LIMBS, expected) ||
+                private_key.decrypt(wide.query(members[e])) != 1) {
+                std::cout << "Fixed-width member lost: " << members[e] << std::endl;
+                return 1;
+            }
+        }
+        std::cout << "Fixed-width members recovered: Yes" << std::endl;
+
+        // 种子压缩序列化：接收方重新展开的 slab 与原 slab 逐字节相同
+        std::vector<unsigned char> compressed = filter.serializeCompressed();
+        GarbledBloomFilter restored = GarbledBloomFilter::deserializeCompressed(compressed.data(), compressed.size());
+        GBFView original = filter.getFilter();
+        GBFView copy = restored.getFilter();
+        size_t slabBytes = original.size() * original.rowLimbs() * sizeof(uint64_t);
+        bool same = copy.size() == original.size() && copy.rowLimbs() == original.rowLimbs() &&
+                    std::memcmp(copy.data(), original.data(), slabBytes) == 0;
+        std::cout << "Compressed " << slabBytes << " -> " << compressed.size() << " bytes, round trip: "
+                  << (same ? "Yes" : "No") << std::endl;
+        if (!same) {
+            return 1;
+        }
+
+        // GBF 文件：读入内存与只读映射后查询结果不变
+        const std::string path = "test_gbf.gbf";
+        GarbledBloomStore::save(path, filter);
+        GarbledBloomFilter loaded = GarbledBloomStore::load<GBF_DYNAMIC_SHARE_BITS>(path);
+        GarbledBloomFilter mapped = GarbledBloomStore::map<GBF_DYNAMIC_SHARE_BITS>(path);
+        std::remove(path.c_str());
+        for (const auto& element : members) {
+            if (loaded.query(element) != filter.query(element) || mapped.query(element) != filter.query(element)) {
+                std::cout << "GBF file mismatch: " << element << std::endl;
+                return 1;
+            }
+        }
+        // 文件不携带 seed
+        static const unsigned char zeroSeed[GarbledBloomFilter::SEED_SIZE] = {0};
+        if (std::memcmp(loaded.getSeed(), zeroSeed, sizeof(zeroSeed)) != 0 ||
+            std::memcmp(mapped.getSeed(), zeroSeed, sizeof(zeroSeed)) != 0) {
+            std::cout << "GBF file leaks the seed" << std::endl;
+            return 1;
+        }
+        std::cout << "GBF file round trip: Yes" << std::endl;
+
+        // 按误判率选参数：k 与 m 随目标变化，k 在压缩序列化与文件中保留
+        std::cout << "检查按误判率选参..." << std::endl;
+        GBFSizingPolicy policy;
+        policy.false_positive_rate = 1e-4;
+        GarbledBloomFilter128 sized(members.size(), policy);
+        sized.generate(members, payloads.data());
+        GBFBuildStats stats = sized.getBuildStats();
+        std::cout << "k = " << sized.getNumHashes() << ", m = " << sized.size() << ", failed inserts = "
+                  << stats.failed_inserts << std::endl;
+        std::vector<unsigned char> sizedBytes = sized.serializeCompressed();
+        GarbledBloomFilter128 sizedCopy =
+            GarbledBloomFilter128::deserializeCompressed(sizedBytes.data(), sizedBytes.size());
+        GarbledBloomStore::save(path, sized);
+        GarbledBloomFilter128 sizedMapped = GarbledBloomStore::map<128>(path);
+        std::remove(path.c_str());
+        for (size_t e = 0; e < members.size(); e++) {
+            uint64_t key[GarbledBloomFilter128::ROW_LIMBS];
+            uint64_t copyKey[GarbledBloomFilter128::ROW_LIMBS];
+            uint64_t mappedKey[GarbledBloomFilter128::ROW_LIMBS];
+            sized.query(members[e], key);
+            sizedCopy.query(members[e], copyKey);
+            sizedMapped.query(members[e], mappedKey);
+            const uint64_t* expected = &payloads[e * GarbledBloomFilter128::ROW_LIMBS];
+            if (sized.getNumHashes() != 13 || stats.failed_inserts != 0 ||
+                !std::equal(key, key + GarbledBloomFilter128::ROW_LIMBS, expected) ||
+                !std::equal(copyKey, copyKey + GarbledBloomFilter128::ROW_LIMBS, expected) ||
+                !std::equal(mappedKey, mappedKey + GarbledBloomFilter128::ROW_LIMBS, expected)) {
+                std::cout << "Sized GBF member lost: " << members[e] << std::endl;
+                return 1;
+            }
+        }
+        std::cout << "Sized GBF round trip: Yes" << std::endl;
+
     } catch (const std::exception& e) {
         std::cerr << "Error: " << e.what() << std::endl;
         return 1;
@@ -14,9 +14,10 @@ int main() {
                   << ", key_bits=" << key_bits << std::endl;
 
         // 2. 生成Paillier密钥对
-        std::cout << "\nGenerating Paillier keys..." << std::endl;
+        std::cout << "\nLoading Paillier keys..." << std::endl;
         auto start = std::chrono::high_resolution_clock::now();
-        PaillierKeyPair keys = PaillierKeyPair::generate(key_bits);
+        PaillierKeyPair keys = PaillierKeyPair::load_or_generate(
+            "paillier_" + std::to_string(key_bits) + ".key", key_bits);
         auto end = std::chrono::high_resolution_clock::now();
         auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end - start);
         std::cout << "Key generation time: " << duration.count() << "ms" << std::endl;
@@ -1,6 +1,7 @@
 #include "PaillierCrypto.h"
 #include <iostream>
 #include <string>
+#include <vector>
 
 int main() {
     try {
@@ -47,6 +48,35 @@ int main() {
         std::cout << "Decrypted product: " << decrypted_product << std::endl;
         std::cout << "Actual product (m1*scalar): " << (m1 * scalar) << std::endl;
         
+        // 回归测试：g = n + 1 的闭式加密 / add_plain 与 mpz_powm 计算结果一致
+        std::cout << "\nChecking g^m closed form against mpz_powm..." << std::endl;
+        mpz_class n = public_key.get_n();
+        mpz_class n_squared = public_key.get_n_squared();
+        mpz_class g = public_key.get_g();
+        mpz_class r = PaillierUtil::random_r(n);
+        std::vector<mpz_class> plains = {0, 1, 123456, -1, -50, n - 1, -(n - 1), n / 3};
+        int mismatches = 0;
+        for (const auto& m : plains) {
+            mpz_class g_m, r_n;
+            mpz_powm(g_m.get_mpz_t(), g.get_mpz_t(), m.get_mpz_t(), n_squared.get_mpz_t());
+            mpz_powm(r_n.get_mpz_t(), r.get_mpz_t(), n.get_mpz_t(), n_squared.get_mpz_t());
+            mpz_class expected_c = (g_m * r_n) % n_squared;
+            mpz_class expected_add = (c1 * g_m) % n_squared;
+
+            if (public_key.encrypt_raw(m, r) != expected_c) {
+                std::cout << "encrypt_raw mismatch for m = " << m << std::endl;
+                mismatches++;
+            }
+            if (PaillierHomomorphic::add_plain(public_key, c1, m) != expected_add) {
+                std::cout << "add_plain mismatch for m = " << m << std::endl;
+                mismatches++;
+            }
+        }
+        std::cout << "Closed form matches mpz_powm: " << (mismatches == 0 ? "Yes" : "No") << std::endl;
+        if (mismatches != 0) {
+            return 1;
+        }
+        
     } catch (const std::exception& e) {
         std::cerr << "Error: " << e.what() << std::endl;
         return 1;
@@ -1,5 +1,6 @@
 #include <iostream>
 #include <gmpxx.h>
+#include <vector>
 #include "seq.h"
 #include "PaillierCrypto.h"
 
@@ -91,6 +92,62 @@ int main() {
         
         std::cout << "大数明文: " << big_num << " -> 解密: " << dec_big << std::endl;
 
+        // 9. 测试批量 SEP/SCP（打包后一次解密）
+        std::cout << "\n[9] 测试批量 SEP_MPSI / SEP_TMPSI / SCP..." << std::endl;
+        std::vector<long> xs_plain = {0, 3, -7, 42, 5, 100000, -1, 8};
+        std::vector<long> ys_plain = {0, 3, 7, 41, 9, 100000, 1, -8};
+        std::vector<EncryptedNumber> xs, ys;
+        for (size_t i = 0; i < xs_plain.size(); ++i) {
+            xs.push_back(EncryptedNumber(pk.encrypt(xs_plain[i]), pk));
+            ys.push_back(EncryptedNumber(pk.encrypt(ys_plain[i]), pk));
+        }
+        std::vector<EncryptedNumber> mpsi = SEP_MPSI_batch(xs, ys, sk);
+        std::vector<EncryptedNumber> tmpsi = SEP_TMPSI_batch(xs, ys, sk);
+        std::vector<mpz_class> scp = SCP_batch(xs, threshold, sk);
+        int mismatches = 0;
+        for (size_t i = 0; i < xs_plain.size(); ++i) {
+            mpz_class expected_eq = (xs_plain[i] == ys_plain[i]) ? 2 : 0;
+            mpz_class expected_scp = (xs_plain[i] < threshold) ? -1 : 1;
+            if (sk.decrypt_small(mpsi[i].getCiphertext()) != expected_eq ||
+                sk.decrypt_small(tmpsi[i].getCiphertext()) != expected_eq || scp[i] != expected_scp) {
+                std::cout << "不一致: " << xs_plain[i] << " vs " << ys_plain[i] << std::endl;
+                mismatches++;
+            }
+        }
+        std::cout << "批量结果与逐个比较一致: " << (mismatches == 0 ? "Yes" : "No") << std::endl;
+        if (mismatches != 0) {
+            return 1;
+        }
+
+        // 10. 测试 EC-ElGamal 后端
+        std::cout << "\n[10] 测试 EC-ElGamal 后端 SEP_MPSI / SEP_TMPSI / SCP..." << std::endl;
+        ECElGamalPrivateKey ec_sk = ECElGamalPrivateKey::generate();
+        const ECElGamalPublicKey& ec_pk = ec_sk.get_public_key();
+        ECEncryptedNumber ec_sum = ECEncryptedNumber(ec_pk.encrypt(20), ec_pk) * 3 +
+                                   (-ECEncryptedNumber(ec_pk.encrypt(-70000), ec_pk));
+        std::vector<unsigned char> bytes = ec_sum.getCiphertext().serialize();
+        ECElGamalCiphertext restored = ECElGamalCiphertext::deserialize(ec_pk.get_group(), bytes.data());
+        std::cout << "密文 " << bytes.size() << " 字节，3*20 + 70000 = " << ec_sk.decrypt_small(restored) << std::endl;
+        if (ec_sk.decrypt_small(restored) != 70060) {
+            return 1;
+        }
+        for (size_t i = 0; i < xs_plain.size(); ++i) {
+            ECEncryptedNumber x(ec_pk.encrypt(xs_plain[i]), ec_pk);
+            ECEncryptedNumber y(ec_pk.encrypt(ys_plain[i]), ec_pk);
+            mpz_class expected_eq = (xs_plain[i] == ys_plain[i]) ? 2 : 0;
+            mpz_class expected_scp = (xs_plain[i] < threshold) ? -1 : 1;
+            if (ec_sk.decrypt_small(SEP_MPSI(x, y, ec_sk).getCiphertext()) != expected_eq ||
+                ec_sk.decrypt_small(SEP_TMPSI(x, y, ec_sk).getCiphertext()) != expected_eq ||
+                SCP(x, threshold, ec_sk) != expected_scp) {
+                std::cout << "不一致: " << xs_plain[i] << " vs " << ys_plain[i] << std::endl;
+                mismatches++;
+            }
+        }
+        std::cout << "EC-ElGamal 结果与 Paillier 一致: " << (mismatches == 0 ? "Yes" : "No") << std::endl;
+        if (mismatches != 0) {
+            return 1;
+        }
+
     } catch (const std::exception& e) {
         std::cerr << "错误: " << e.what() << std::endl;
         return 1;